@@ -22,21 +22,177 @@
 #include "jack_link.hpp"
 
 #include "jack_link_log.hpp"
+#include "jack_link_convert.hpp"
 
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <sstream>
+#include <vector>
 #include <algorithm>
 #include <cctype>
 #include <csignal>
 
+#include <unistd.h>
 
-jack_link::jack_link ( const std::string& name ) :
-	m_name(name), m_link(120.0), m_client(nullptr),
-	m_srate(44100.0), m_timebase(0), m_npeers(0),
-	m_tempo(120.0), m_tempo_req(0.0), m_quantum(4.0),
-	m_playing(false), m_playing_req(false),
-	m_running(false), m_thread(nullptr)
+
+// Supervised JACK client reconnection back-off (min, max).
+static const std::chrono::milliseconds c_client_retry_min(20);
+static const std::chrono::milliseconds c_client_retry_max(500);
+
+// Lost JACK timebase reclaim attempts (min. interval).
+static const std::chrono::seconds c_timebase_retry(1);
+
+
+//---------------------------------------------------------------------
+// jack_link_options -- impl.
+//
+
+// Parse command line option (and argument).
+bool jack_link_options::parse ( int& i, int argc, char **argv )
+{
+	const std::string arg = argv[i];
+
+	if (!arg.compare("-O") || !arg.compare("--observer")) {
+		observer = true;
+	}
+	else
+	if (!arg.compare("-o") || !arg.compare("--osc")) {
+		if (++i < argc)
+			osc = argv[i];
+	}
+	else
+	if (!arg.compare("-l") || !arg.compare("--ltc")) {
+		if (++i < argc)
+			ltc = argv[i];
+	}
+	else
+	if (!arg.compare("-a") || !arg.compare("--at")) {
+		if (++i < argc)
+			schedule.push_back(argv[i]);
+	}
+	else
+	if (!arg.compare("-f") || !arg.compare("--file")) {
+		if (++i < argc) {
+			std::ifstream ifs(argv[i]);
+			if (!ifs)
+				jack_link_log("Could not open script file: %s.", argv[i]);
+			std::string line;
+			while (std::getline(ifs, line)) {
+				line.erase(std::min(line.find('#'), line.size()));
+				if (line.find_first_not_of(" \t\r") != std::string::npos)
+					schedule.push_back(line);
+			}
+		}
+	}
+	else
+	if (!arg.compare("-s") || !arg.compare("--supervised")) {
+		supervised = true;
+	}
+	else
+	if (!arg.compare("-C") || !arg.compare("--control")) {
+		if (++i < argc)
+			control = argv[i];
+	}
+	else
+	if (!arg.compare("-r") || !arg.compare("--tempo-rate")) {
+		double hz = 0.0;
+		if (++i < argc)
+			std::istringstream(argv[i]) >> hz;
+		if (hz > 0.0)
+			tempo_rate = hz;
+	}
+	else
+	if (!arg.compare("-H") || !arg.compare("--tempo-hysteresis")) {
+		double bpm = -1.0;
+		if (++i < argc)
+			std::istringstream(argv[i]) >> bpm;
+		if (bpm >= 0.0)
+			tempo_hysteresis = bpm;
+	}
+	else
+	if (!arg.compare("-R") || !arg.compare("--ramp")) {
+		double beats = -1.0;
+		if (++i < argc)
+			std::istringstream(argv[i]) >> beats;
+		if (beats >= 0.0)
+			ramp = beats;
+	}
+	else
+	if (!arg.compare("--ramp-curve")) {
+		if (++i < argc)
+			ramp_curve = argv[i];
+		if (ramp_curve.compare("linear") && ramp_curve.compare("exponential")) {
+			jack_link_log("Invalid ramp curve: %s.", ramp_curve.c_str());
+			ramp_curve = "linear";
+		}
+	}
+	else
+		return false;
+
+	return true;
+}
+
+
+// Parse options string (eg. internal client load init).
+void jack_link_options::parse ( const std::string& args )
+{
+	std::vector<std::string> tokens;
+	std::istringstream iss(args);
+	std::string token;
+	while (iss >> token)
+		tokens.push_back(token);
+
+	std::vector<char *> argv;
+	argv.push_back(const_cast<char *> (JACK_LINK_NAME));
+	for (std::string& t : tokens)
+		argv.push_back(&t[0]);
+
+	const int argc = int(argv.size());
+	for (int i = 1; i < argc; ++i) {
+		if (!parse(i, argc, argv.data()))
+			jack_link_log("Ignoring option: %s.", argv[i]);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// jack_link -- impl.
+//
+
+jack_link::jack_link (
+	const std::string& name, const jack_link_options& options ) :
+	jack_link(name, options, nullptr)
+{
+}
+
+
+jack_link::jack_link (
+	jack_client_t *client, const jack_link_options& options ) :
+	jack_link(::jack_get_client_name(client), options, client)
+{
+}
+
+
+jack_link::jack_link ( const std::string& name,
+	const jack_link_options& options, jack_client_t *client ) :
+	jack_link_core(client), m_name(name), m_options(options),
+	m_client_extern(client != nullptr), m_client_lost(nullptr),
+	m_client_retry(c_client_retry_min),
+	m_timebase_last(0), m_timebase_frame(0),
+	m_timebase_master(false), m_timebase_lost(false), m_timebase_retry(0),
+	m_timebase_refresh(false), m_timebase_refresh_time(0), m_npeers(0),
+	m_running(false), m_thread(nullptr),
+	m_worker_state(JackTransportStopped), m_worker_notify(false),
+	m_worker_freewheel(false),
+	m_worker_timeout(100), m_worker_events(0), m_idle_wakeups(0),
+	m_follow_tempo(0.0), m_follow_commit(0),
+	m_tempo_commits(0), m_freewheels(0),
+	m_xruns(0), m_buffer_size_changes(0), m_srate_changes(0),
+	m_osc(m_link.clock()), m_osc_beat(0.0), m_osc_tempo(0.0),
+	m_ltc_port(nullptr), m_startup_time(0),
+	m_startup_jack(-1), m_startup_timebase(-1), m_startup_peer(-1),
+	m_startup_reported(0), m_process_closing(false), m_process_refs(0)
 {
 	m_link.setNumPeersCallback([this](const std::size_t npeers)
 		{ peers_callback(npeers); });
@@ -47,6 +203,11 @@ jack_link::jack_link ( const std::string& name ) :
 
 	m_link.enableStartStopSync(true);
 
+	ramp_setup(m_options.ramp,
+		m_options.ramp_curve.compare("exponential")
+			? RampLinear : RampExponential,
+		m_options.tempo_rate);
+
 	initialize();
 }
 
@@ -65,6 +226,10 @@ const std::string& jack_link::name (void) const
 
 bool jack_link::active (void) const
 {
+	// Supervised mode stays active while JACK is away...
+	if (m_options.supervised && m_link.isEnabled())
+		return true;
+
 	return (m_client != nullptr);
 }
 
@@ -89,6 +254,21 @@ double jack_link::quantum (void) const
 
 void jack_link::tempo ( double tempo )
 {
+	if (m_options.observer)
+		return;
+
+	// Ramped by the timebase callback, when in charge...
+	if (m_options.ramp > 0.0 && tempo > 0.0) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_timebase_master) {
+			m_ramp_req = tempo;
+			// Stopped: no timebase callback until relocated...
+			timebase_refresh();
+			worker_notify();
+			return;
+		}
+	}
+
 	if (m_npeers > 0) {
 		auto session_state = m_link.captureAppSessionState();
 		const auto host_time = m_link.clock().micros();
@@ -97,8 +277,8 @@ void jack_link::tempo ( double tempo )
 	} else {
 		std::lock_guard<std::mutex> lock(m_mutex);
 		m_tempo_req = tempo;
-		timebase_reset();
-		m_cond.notify_one();
+		timebase_refresh();
+		worker_notify();
 	}
 }
 
@@ -111,6 +291,9 @@ double jack_link::tempo (void) const
 
 void jack_link::playing ( bool playing )
 {
+	if (m_options.observer)
+		return;
+
 	if (m_npeers > 0) {
 		auto session_state = m_link.captureAppSessionState();
 		const auto host_time = m_link.clock().micros();
@@ -121,7 +304,7 @@ void jack_link::playing ( bool playing )
 		m_playing_req = true;
 		m_playing = playing;
 		transport_reset();
-		m_cond.notify_one();
+		worker_notify();
 	}
 }
 
@@ -132,34 +315,308 @@ bool jack_link::playing (void) const
 }
 
 
-int jack_link::process_callback (
-	jack_nframes_t /*nframes*/, void */*user_data*/ )
+jack_link_stats jack_link::stats (void) const
 {
-	return 0;
+	jack_link_stats stats;
+	stats.relocations = m_relocations;
+	stats.resyncs = m_resyncs;
+	stats.idle_wakeups = m_idle_wakeups;
+	stats.tempo_commits = m_tempo_commits;
+	stats.freewheels = m_freewheels;
+	stats.xruns = m_xruns;
+	stats.buffer_size_changes = m_buffer_size_changes;
+	stats.srate_changes = m_srate_changes;
+	if (m_startup_jack >= 0)
+		stats.startup_jack = 0.001 * m_startup_jack;
+	if (m_startup_timebase >= 0)
+		stats.startup_timebase = 0.001 * m_startup_timebase;
+	if (m_startup_peer >= 0)
+		stats.startup_peer = 0.001 * m_startup_peer;
+	stats.observed = m_observed;
+	stats.jack_divergence = m_jack_divergence;
+	stats.jack_divergence_max = m_jack_divergence_max;
+	stats.link_divergence = m_link_divergence;
+	stats.link_divergence_max = m_link_divergence_max;
+	const unsigned long jack_observed = m_jack_observed;
+	if (jack_observed > 0)
+		stats.jack_divergence_avg = m_jack_divergence_sum / jack_observed;
+	if (stats.observed > 0)
+		stats.link_divergence_avg = m_link_divergence_sum / stats.observed;
+	return stats;
 }
 
 
-int jack_link::sync_callback (
-	jack_transport_state_t state, jack_position_t *position, void *user_data )
+bool jack_link::schedule ( const std::string& spec )
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return schedule_parse(spec);
+}
+
+
+// Interactive/control commands ("help" for a list).
+bool jack_link::command ( const std::string& cmd, std::ostream& out )
+{
+	const char *ws = " \t\n\r";
+
+	std::string line = cmd;
+	line.erase(0, std::min(line.find_first_not_of(ws), line.size()));
+	line.erase(line.find_last_not_of(ws) + 1);
+	std::transform(
+		line.begin(), line.end(),
+		line.begin(), ::tolower);
+
+	std::string arg;
+	const std::string::size_type pos
+		= line.find_first_of(' ');
+	if (pos != std::string::npos) {
+		arg = line.substr(pos + 1);
+		arg.erase(0, arg.find_first_not_of(ws));
+		line.erase(pos);
+	}
+
+	if (!line.compare("quit") || !line.compare("exit"))
+		return false;
+
+	if (!line.compare("start"))
+		playing(true);
+	else
+	if (!line.compare("stop"))
+		playing(false);
+	else
+	if (!line.compare("tempo")) {
+		double bpm = 0.0;
+		std::istringstream(arg) >> bpm;
+		if (bpm > 0.0)
+			tempo(bpm);
+		else
+			out << "tempo: " << tempo() << std::endl;
+	}
+	else
+	if (!line.compare("at")) {
+		if (!schedule(arg))
+			out << "?Invalid scheduled command." << std::endl;
+	}
+	else
+	if (!line.compare("status")) {
+		out << "name: "    << name()    << std::endl;
+		out << "npeers: "  << npeers()  << std::endl;
+		out << "srate: "   << srate()   << std::endl;
+		out << "tempo: "   << tempo()   << std::endl;
+		out << "quantum: " << quantum() << std::endl;
+		out << "playing: " <<
+			(playing() ? "started" : "stopped") << std::endl;
+	}
+	else
+	if (!line.compare("stats")) {
+		const jack_link_stats stats = jack_link::stats();
+		out << "relocations: " << stats.relocations << std::endl;
+		out << "resyncs: " << stats.resyncs << std::endl;
+		out << "idle_wakeups: " << stats.idle_wakeups << std::endl;
+		out << "tempo_commits: " << stats.tempo_commits << std::endl;
+		out << "freewheels: " << stats.freewheels << std::endl;
+		out << "xruns: " << stats.xruns << std::endl;
+		out << "buffer_size_changes: " << stats.buffer_size_changes << std::endl;
+		out << "srate_changes: " << stats.srate_changes << std::endl;
+		out << "startup_jack: " << stats.startup_jack << " ms" << std::endl;
+		out << "startup_timebase: " << stats.startup_timebase << " ms" << std::endl;
+		out << "startup_peer: " << stats.startup_peer << " ms" << std::endl;
+		out << "observed: " << stats.observed << std::endl;
+		out << "jack_divergence: " << stats.jack_divergence
+			<< " (max " << stats.jack_divergence_max
+			<< ", avg " << stats.jack_divergence_avg << ")" << std::endl;
+		out << "link_divergence: " << stats.link_divergence
+			<< " (max " << stats.link_divergence_max
+			<< ", avg " << stats.link_divergence_avg << ")" << std::endl;
+	}
+	else
+	if (!line.compare("version")) {
+		out << JACK_LINK_NAME " v" JACK_LINK_VERSION
+			" (Link v" ABLETON_LINK_VERSION ")" << std::endl;
+	}
+	else
+	if (!line.compare("help")) {
+		out << "help | start | stop";
+		out << " | tempo [bpm] | at <when> <command> | status | stats";
+		out << " | version | quit | exit" << std::endl;
+	}
+	else
+	if (!line.empty())
+		out << "?Invalid command." << std::endl;
+
+	return true;
+}
+
+
+// Control pipe commands (reader thread), replies logged.
+void jack_link::control_command ( const std::string& cmd )
+{
+	std::ostringstream out;
+	if (!command(cmd, out))
+		jack_link_log("Ignoring control command: %s.", cmd.c_str());
+
+	std::istringstream iss(out.str());
+	std::string line;
+	while (std::getline(iss, line))
+		jack_link_log("%s", line.c_str());
+}
+
+
+jack_link_state_t jack_link::state (void) const
+{
+	return m_state.load().state;
+}
+
+
+bool jack_link::frames_to_beats ( const jack_nframes_t *frames,
+	double *beats, double *phases, std::size_t n ) const
+{
+	const jack_link_cycle cycle = m_state.load();
+	const jack_link_convert convert(cycle.state, cycle.tempo);
+	if (!convert.valid())
+		return false;
+
+	convert.frames_to_beats(frames, beats, phases, n);
+	return true;
+}
+
+
+bool jack_link::beats_to_frames ( const double *beats,
+	jack_nframes_t *frames, std::size_t n ) const
+{
+	const jack_link_cycle cycle = m_state.load();
+	const jack_link_convert convert(cycle.state, cycle.tempo);
+	if (!convert.valid())
+		return false;
+
+	convert.beats_to_frames(beats, frames, n);
+	return true;
+}
+
+
+int jack_link::process ( jack_nframes_t nframes )
+{
+	if (!process_enter())
+		return 0;
+
+	const int ret = (m_client ? process_callback(nframes) : 0);
+
+	process_leave();
+
+	return ret;
+}
+
+
+void jack_link::freewheel ( int starting )
+{
+	freewheel_callback(starting);
+}
+
+
+void jack_link::xrun (void)
+{
+	xrun_callback();
+}
+
+
+void jack_link::buffer_size ( jack_nframes_t nframes )
+{
+	buffer_size_callback(nframes);
+}
+
+
+void jack_link::srate ( jack_nframes_t srate )
+{
+	srate_callback(srate);
+}
+
+
+int jack_link::process_callback ( jack_nframes_t nframes, void *user_data )
 {
 	jack_link *pJackLink = static_cast<jack_link *> (user_data);
-	return pJackLink->sync_callback(state, position);
+	return pJackLink->process_callback(nframes);
 }
 
 
-int jack_link::sync_callback (
-	jack_transport_state_t state, jack_position_t *pos )
+int jack_link::process_callback ( jack_nframes_t nframes )
 {
-	if (state == JackTransportStarting && m_playing && !m_playing_req) {
-		// Sync to current JACK transport frame-beat quantum...
-		auto session_state = m_link.captureAudioSessionState();
-		const auto host_time = m_link.clock().micros();
-		const double beat = position_beat(pos);
-		session_state.forceBeatAtTime(beat, host_time, m_quantum);
-		m_link.commitAudioSessionState(session_state);
+	// Buffer size or sample rate changed...
+	if (config_update() && m_ltc_port)
+		m_ltc.reset(m_srate);
+
+	jack_position_t pos;
+	const jack_transport_state_t state
+		= Transport::query(m_client, &pos);
+
+	// Render timecode, following the JACK transport frame...
+	if (m_ltc_port) {
+		float *buf = static_cast<float *> (
+			::jack_port_get_buffer(m_ltc_port, nframes));
+		m_ltc.process(buf, nframes, state, pos.frame);
+	}
+
+	// Offline render: no Link nor worker interaction whatsoever...
+	if (m_freewheel) {
+		m_worker_freewheel = true;
+		return 0;
+	}
+
+	// Back to realtime: have the worker catch up...
+	if (m_worker_freewheel) {
+		m_worker_freewheel = false;
+		m_worker_notify = true;
+	}
+
+	if (!m_options.observer)
+		schedule_process(state, nframes, &pos);
+
+	if (m_transport_req != TransportNone)
+		transport_process(state, nframes, &pos);
+
+	if (m_options.observer)
+		observer_process(nframes);
+
+	if (m_osc.active())
+		osc_process(nframes);
+
+	// Wake up the worker on JACK transport state changes...
+	if (m_worker_state != state) {
+		m_worker_state = state;
+		m_worker_notify = true;
+	}
+
+	state_process(state, &pos);
+
+	// Track JACK tempo changes as they happen (tempo follower)...
+	if (Transport::bbt(&pos)
+		&& pos.beats_per_minute != m_follow_tempo) {
+		m_follow_tempo = pos.beats_per_minute;
+		if (std::abs(pos.beats_per_minute - m_tempo) > m_options.tempo_hysteresis)
+			m_worker_notify = true;
+	}
+
+	// Otherwise retried on next cycle...
+	if (m_worker_notify && m_mutex.try_lock()) {
+		worker_notify();
+		m_mutex.unlock();
+		m_worker_notify = false;
 	}
 
-	return 1;
+	return 0;
+}
+
+
+int jack_link::sync_callback (
+	jack_transport_state_t state, jack_position_t *position, void *user_data )
+{
+	jack_link *pJackLink = static_cast<jack_link *> (user_data);
+	if (!pJackLink->process_enter())
+		return 1;
+
+	const int ret = pJackLink->sync_process(state, position);
+
+	pJackLink->process_leave();
+
+	return ret;
 }
 
 
@@ -168,45 +625,109 @@ void jack_link::timebase_callback (
 	jack_position_t *pos, int new_pos, void *user_data )
 {
 	jack_link *pJackLink = static_cast<jack_link *> (user_data);
-	pJackLink->timebase_callback(state, nframes, pos, new_pos);
+	if (!pJackLink->process_enter())
+		return;
+
+	pJackLink->timebase_process(state, nframes, pos, new_pos);
+
+	// First one ever? (process thread, have the worker report)
+	if (pJackLink->m_startup_timebase < 0) {
+		pJackLink->startup_mark(pJackLink->m_startup_timebase);
+		pJackLink->m_worker_notify = true;
+	}
+
+	pJackLink->process_leave();
 }
 
 
-void jack_link::timebase_callback (
-	jack_transport_state_t /*state*/, jack_nframes_t /*nframes*/,
-	jack_position_t *pos, int new_pos )
+// Real-time entry guard, shared client (closing on its way).
+bool jack_link::process_enter (void)
 {
-	if (m_tempo_req > 0.0 && m_mutex.try_lock()) {
-		m_tempo = m_tempo_req;
-		m_tempo_req = 0.0;
-		m_mutex.unlock();
+	++m_process_refs;
+
+	if (m_process_closing) {
+		--m_process_refs;
+		return false;
 	}
 
-	const auto frame_time = std::chrono::microseconds(
-		std::llround(1.0e6 * pos->frame / pos->frame_rate));
+	return true;
+}
+
+
+void jack_link::process_leave (void)
+{
+	--m_process_refs;
+}
 
-	const double beats_per_minute = m_tempo;
-	const double beats_per_bar = std::max(m_quantum, 1.0);
 
-	const double beats = beats_per_minute * frame_time.count() / 60.0e6;
-	const double bar = std::floor(beats / beats_per_bar);
-	const double beat = beats - bar * beats_per_bar;
+void jack_link::freewheel_callback ( int starting, void *user_data )
+{
+	jack_link *pJackLink = static_cast<jack_link *> (user_data);
+	pJackLink->freewheel_callback(starting);
+}
 
-	const bool   valid = (pos->valid & JackPositionBBT);
-	const double ticks_per_beat = (valid ? pos->ticks_per_beat : 960.0);
-	const float  beat_type = (valid ? pos->beat_type : 4.0f);
 
-	pos->valid = JackPositionBBT;
-	pos->bar = int32_t(bar) + 1;
-	pos->beat = int32_t(beat) + 1;
-	pos->tick = int32_t(ticks_per_beat * (beat - std::floor(beat)));
-	pos->beats_per_bar = float(beats_per_bar);
-	pos->ticks_per_beat = ticks_per_beat;
-	pos->beats_per_minute = beats_per_minute;
-	pos->beat_type = beat_type;
-	pos->bar_start_tick = bar * beats_per_bar * ticks_per_beat;
+void jack_link::freewheel_callback ( int starting )
+{
+	freewheel_process(starting);
 
-	if (new_pos) ++m_timebase;
+	if (starting)
+		++m_freewheels;
+}
+
+
+int jack_link::xrun_callback ( void *user_data )
+{
+	jack_link *pJackLink = static_cast<jack_link *> (user_data);
+	return pJackLink->xrun_callback();
+}
+
+
+int jack_link::buffer_size_callback ( jack_nframes_t nframes, void *user_data )
+{
+	jack_link *pJackLink = static_cast<jack_link *> (user_data);
+	return pJackLink->buffer_size_callback(nframes);
+}
+
+
+int jack_link::srate_callback ( jack_nframes_t srate, void *user_data )
+{
+	jack_link *pJackLink = static_cast<jack_link *> (user_data);
+	return pJackLink->srate_callback(srate);
+}
+
+
+int jack_link::xrun_callback (void)
+{
+	xrun_process();
+
+	++m_xruns;
+
+	return 0;
+}
+
+
+int jack_link::buffer_size_callback ( jack_nframes_t nframes )
+{
+	// Also called on activation, unchanged...
+	if (nframes != m_buffer_size) {
+		buffer_size_process(nframes);
+		++m_buffer_size_changes;
+	}
+
+	return 0;
+}
+
+
+int jack_link::srate_callback ( jack_nframes_t srate )
+{
+	// Also called on activation, unchanged...
+	if (double(srate) != m_srate) {
+		srate_process(srate);
+		++m_srate_changes;
+	}
+
+	return 0;
 }
 
 
@@ -221,6 +742,17 @@ void jack_link::on_shutdown (void)
 {
 	jack_link_log("jack_link::on_shutdown()");
 
+	if (m_options.supervised && !m_client_extern) {
+		// Keep on Link and have the worker reconnecting...
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_client_lost = m_client;
+		m_client = nullptr;
+		m_client_retry = c_client_retry_min;
+		m_timebase_master = false;
+		worker_notify();
+		return;
+	}
+
 	m_client = nullptr;
 
 	terminate();
@@ -229,17 +761,20 @@ void jack_link::on_shutdown (void)
 	std::cerr << std::endl;
 
 //	std::terminate();
-	::raise(SIGTERM);
+	::kill(::getpid(), SIGTERM);
 }
 
 
 void jack_link::peers_callback ( const std::size_t npeers )
 {
+	// Marked right away, never held up by the lock...
+	if (npeers > 0 && m_startup_peer < 0)
+		startup_mark(m_startup_peer);
+
 	std::lock_guard<std::mutex> lock(m_mutex);
 	jack_link_log("jack_link::peers_callback(%u)", npeers);
 	m_npeers = npeers;
-	timebase_reset();
-	m_cond.notify_one();
+	worker_notify();
 }
 
 
@@ -248,8 +783,8 @@ void jack_link::tempo_callback ( const double tempo )
 	std::lock_guard<std::mutex> lock(m_mutex);
 	jack_link_log("jack_link::tempo_callback(%g)", tempo);
 	m_tempo_req = tempo;
-	timebase_reset();
-	m_cond.notify_one();
+	timebase_refresh();
+	worker_notify();
 }
 
 
@@ -265,19 +800,65 @@ void jack_link::playing_callback ( const bool playing )
 	jack_link_log("jack_link::playing_callback(%d)", int(playing));
 	m_playing_req = true;
 	m_playing = playing;
-	transport_reset();
-	m_cond.notify_one();
+	transport_schedule();
+	worker_notify();
 }
 
 
 void jack_link::initialize (void)
 {
+	m_startup_time = m_link.clock().micros();
+
+	// Start Link peer discovery right away, concurrently
+	// with the (blocking) JACK client handshake below,
+	// with no lock held, so Link callbacks get through...
+	m_link.enable(true);
+
+	if (!m_options.osc.empty())
+		m_osc.open(m_options.osc);
+
+	if (!m_options.control.empty()) {
+		m_control.open(m_options.control,
+			[this](const std::string& cmd){ control_command(cmd); });
+	}
+
+	jack_client_t *client = m_client;
+	if (!m_client_extern)
+		client = client_connect(JackNullOption, true);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
 	m_thread = new std::thread([this]{ worker_start(); });
 //	m_thread->detach();
 
+	if (client) {
+		m_client = client;
+		client_setup();
+		// Catch up with Link start/stop meanwhile...
+		transport_schedule();
+	}
+	else
+	if (m_options.supervised) {
+		jack_link_log("Retrying JACK client...");
+	} else {
+	//	std::terminate();
+		::kill(::getpid(), SIGTERM);
+		return;
+	}
+
+	for (const std::string& spec : m_options.schedule)
+		schedule_parse(spec);
+}
+
+
+jack_client_t *jack_link::client_connect ( jack_options_t options, bool verbose )
+{
 	jack_status_t status = JackFailure;
-	m_client = ::jack_client_open(m_name.c_str(), JackNullOption, &status);
-	if (m_client == nullptr) {
+	jack_client_t *client
+		= ::jack_client_open(m_name.c_str(), options, &status);
+	if (client == nullptr) {
+		if (!verbose)
+			return nullptr;
 		jack_link_log("Could not initialize JACK client.");
 		if (status & JackFailure)
 			jack_link_log("Overall operation failed.");
@@ -301,27 +882,163 @@ void jack_link::initialize (void)
 			jack_link_log("Unable to access shared memory.");
 		if (status & JackVersionError)
 			jack_link_log("Client protocol version mismatch.");
-	//	std::terminate();
-		::raise(SIGTERM);
-		return;
-	};
+	}
+
+	return client;
+}
+
+
+void jack_link::client_setup (void)
+{
+	config_setup(
+		::jack_get_sample_rate(m_client),
+		::jack_get_buffer_size(m_client));
+
+	// Otherwise driven by the host, through process() et al...
+	if (!m_options.process_hook) {
+		::jack_set_process_callback(m_client, process_callback, this);
+		::jack_set_freewheel_callback(m_client, freewheel_callback, this);
+		::jack_set_xrun_callback(m_client, xrun_callback, this);
+		::jack_set_buffer_size_callback(m_client, buffer_size_callback, this);
+		::jack_set_sample_rate_callback(m_client, srate_callback, this);
+	}
 
-	m_srate = double(::jack_get_sample_rate(m_client));
+	// Observers are plain JACK clients...
+	if (!m_options.observer)
+		::jack_set_sync_callback(m_client, sync_callback, this);
 
-	::jack_set_process_callback(m_client, process_callback, this);
-	::jack_set_sync_callback(m_client, sync_callback, this);
-	::jack_on_shutdown(m_client, on_shutdown, this);
+	// Shutdown is up to whoever owns the client...
+	if (!m_client_extern)
+		::jack_on_shutdown(m_client, on_shutdown, this);
+
+	// Timecode output port, if any...
+	if (!m_options.ltc.empty() && m_ltc.open(m_options.ltc, m_srate)) {
+		m_ltc_port = ::jack_port_register(m_client, "ltc_out",
+			JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput | JackPortIsTerminal, 0);
+		if (m_ltc_port == nullptr)
+			jack_link_log("Could not register LTC output port.");
+	}
 
 	::jack_activate(m_client);
 
-	m_link.enable(true);
+	if (m_startup_jack < 0)
+		startup_mark(m_startup_jack);
 
+	// A fresh client: acquire timebase master right away...
+	m_timebase_lost = false;
 	timebase_reset();
 }
 
 
+void jack_link::client_close (void)
+{
+	// Not ours to close (eg. internal client, embedding host),
+	// just leave it as found, with no callbacks of ours left...
+	if (m_client_extern && m_client) {
+		if (m_options.process_hook) {
+			// Still active, owned by the host: shut real-time
+			// entries out and wait for those still running...
+			m_process_closing = true;
+			if (m_timebase_master)
+				::jack_release_timebase(m_client);
+			if (!m_options.observer)
+				::jack_set_sync_callback(m_client, nullptr, nullptr);
+			std::this_thread::sleep_for(2 * m_period);
+			while (m_process_refs > 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		} else {
+			// Activated by ourselves: no callbacks once deactivated...
+			::jack_deactivate(m_client);
+			if (m_timebase_master)
+				::jack_release_timebase(m_client);
+			::jack_set_process_callback(m_client, nullptr, nullptr);
+			::jack_set_freewheel_callback(m_client, nullptr, nullptr);
+			::jack_set_xrun_callback(m_client, nullptr, nullptr);
+			::jack_set_buffer_size_callback(m_client, nullptr, nullptr);
+			::jack_set_sample_rate_callback(m_client, nullptr, nullptr);
+			if (!m_options.observer)
+				::jack_set_sync_callback(m_client, nullptr, nullptr);
+		}
+		if (m_ltc_port)
+			::jack_port_unregister(m_client, m_ltc_port);
+		m_client = nullptr;
+	}
+
+	if (m_client) {
+		::jack_deactivate(m_client);
+		::jack_client_close(m_client);
+		m_client = nullptr;
+	}
+
+	// Clean up after a server shutdown...
+	if (m_client_lost) {
+		::jack_client_close(m_client_lost);
+		m_client_lost = nullptr;
+	}
+
+	m_timebase_master = false;
+
+	m_ltc_port = nullptr;
+}
+
+
+void jack_link::client_retry ( std::unique_lock<std::mutex>& lock )
+{
+	jack_client_t *client_lost = m_client_lost;
+	m_client_lost = nullptr;
+
+	// Server handshake (blocking) with no lock held, so that
+	// Link callbacks and commands get through meanwhile...
+	lock.unlock();
+
+	if (client_lost)
+		::jack_client_close(client_lost);
+
+	jack_client_t *client = client_connect(JackNoStartServer, false);
+
+	lock.lock();
+
+	// Terminated meanwhile?
+	if (client && !m_running) {
+		::jack_client_close(client);
+		return;
+	}
+
+	if (client) {
+		m_client = client;
+		client_setup();
+		jack_link_log("jack_link::client_retry(): reconnected.");
+		m_client_retry = c_client_retry_min;
+		client_restore();
+	} else {
+		m_client_retry = std::min(2 * m_client_retry, c_client_retry_max);
+	}
+}
+
+
+void jack_link::client_restore (void)
+{
+	if (!m_playing || m_options.observer)
+		return;
+
+	// Relocate to where the Link session currently is and roll...
+	const double quantum = std::max(m_quantum.load(), 1.0);
+	const auto session_state = m_link.captureAppSessionState();
+	const auto host_time = m_link.clock().micros();
+	const double beats = session_state.beatAtTime(host_time, quantum);
+	if (beats > 0.0) {
+		Transport::locate(m_client,
+			jack_nframes_t(60.0 * m_srate * beats / m_tempo));
+	}
+
+	Transport::start(m_client);
+}
+
+
 void jack_link::terminate (void)
 {
+	m_control.close();
+
 	worker_stop();
 
 	if (m_thread) {
@@ -332,11 +1049,12 @@ void jack_link::terminate (void)
 
 	m_link.enable(false);
 
-	if (m_client) {
-		::jack_deactivate(m_client);
-		::jack_client_close(m_client);
-		m_client = nullptr;
-	}
+	// No real-time callbacks past this point, only then
+	// whatever they were using may be freed...
+	client_close();
+
+	m_osc.close();
+	m_ltc.close();
 }
 
 
@@ -345,26 +1063,107 @@ void jack_link::timebase_reset (void)
 	if (m_client == nullptr)
 		return;
 
-	if (m_timebase > 0) {
-		::jack_release_timebase(m_client);
-		m_timebase = 0;
+	// Acquire timebase master only once, or when it was lost...
+	if (m_timebase_master || m_options.observer)
+		return;
+
+	// Once lost, reclaimed conditionally: never taking over
+	// from whichever other client is timebase master now...
+	const int conditional = (m_timebase_lost ? 1 : 0);
+	m_timebase_master = (::jack_set_timebase_callback(
+		m_client, conditional, jack_link::timebase_callback, this) == 0);
+	m_timebase_last = m_timebase;
+
+	if (m_timebase_master) {
+		jack_link_log("jack_link::timebase_reset(): acquired.");
+		m_timebase_lost = false;
+	} else {
+		m_timebase_lost = true;
 	}
+}
 
-	::jack_set_timebase_callback(
-		m_client, 0, jack_link::timebase_callback, this);
+
+void jack_link::timebase_refresh (void)
+{
+	// Stopped JACK transport BBT is refreshed once tempo settles...
+	m_timebase_refresh = true;
+	m_timebase_refresh_time = m_link.clock().micros();
+}
+
+
+void jack_link::timebase_check (
+	jack_transport_state_t state, jack_position_t *pos )
+{
+	const auto host_time = m_link.clock().micros();
+
+	// Lost to some other client: retried at a bounded rate...
+	if (m_timebase_lost && host_time >= m_timebase_retry + c_timebase_retry) {
+		m_timebase_retry = host_time;
+		timebase_reset();
+	}
+
+	if (!m_timebase_master) {
+		m_timebase_refresh = false;
+		return;
+	}
+
+	const bool rolling
+		= Transport::rolling(state);
+
+	// Our timebase callback gets called on every rolling cycle,
+	// unless some other client has taken over as timebase master...
+	const unsigned long timebase = m_timebase;
+	if (rolling && pos->frame != m_timebase_frame
+		&& timebase == m_timebase_last) {
+		jack_link_log("jack_link::timebase_check(): lost.");
+		m_timebase_master = false;
+		m_timebase_lost = true;
+		m_timebase_retry = host_time;
+	}
+
+	m_timebase_last = timebase;
+	m_timebase_frame = pos->frame;
+
+	// Have BBT refreshed when stopped (new position), though not
+	// while tempo keeps changing (eg. sweeps, coalesced) and only
+	// when the published tempo is actually off...
+	if (m_timebase_refresh && !rolling && m_timebase_master) {
+		double tempo = m_ramp_req;
+		if (tempo <= 0.0)
+			tempo = m_tempo_req;
+		if (tempo <= 0.0)
+			tempo = m_tempo;
+		const auto settle_time = m_timebase_refresh_time
+			+ std::chrono::microseconds(std::llround(1.0e6 / m_options.tempo_rate));
+		if (Transport::bbt(pos) && pos->beats_per_minute == tempo) {
+			m_timebase_refresh = false;
+		}
+		else
+		if (host_time < settle_time) {
+			const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds> (
+				settle_time - host_time) + std::chrono::milliseconds(1);
+			m_worker_timeout = std::min(m_worker_timeout, timeout);
+		} else {
+			Transport::locate(m_client, pos->frame);
+			m_timebase_refresh = false;
+		}
+		return;
+	}
+
+	m_timebase_refresh = false;
 }
 
 
 void jack_link::transport_reset (void)
 {
-	if (m_client == nullptr)
+	if (m_client == nullptr || m_options.observer)
 		return;
 
 	if (m_playing_req && m_playing && m_npeers > 0) {
 		jack_position_t pos;
 		const jack_transport_state_t state
-			= ::jack_transport_query(m_client, &pos);
-		if (state == JackTransportStopped) {
+			= Transport::query(m_client, &pos);
+		if (!Transport::rolling(state) && !Transport::starting(state)) {
 			// Sync to current JACK transport frame-beat quantum...
 			auto session_state = m_link.captureAppSessionState();
 			const auto host_time = m_link.clock().micros();
@@ -376,26 +1175,200 @@ void jack_link::transport_reset (void)
 
 	// Start/stop playing on JACK...
 	if (m_playing)
-		::jack_transport_start(m_client);
+		Transport::start(m_client);
 	else
-		::jack_transport_stop(m_client);
+		Transport::stop(m_client);
 }
 
 
-double jack_link::position_beat ( jack_position_t *pos ) const
+void jack_link::transport_schedule (void)
 {
-	if (pos->valid & JackPositionBBT) {
-		const double beats
-			= double(pos->beat - 1)
-			+ double(pos->tick) / double(pos->ticks_per_beat);
-		return beats - double(pos->beats_per_bar);
+	if (m_client == nullptr || m_options.observer)
+		return;
+
+	const jack_transport_state_t state
+		= Transport::query(m_client, nullptr);
+
+	const bool playing
+		= (Transport::rolling(state) || Transport::starting(state));
+
+	if (playing == m_playing) {
+		m_transport_req = TransportNone;
+		return;
+	}
+
+	// Located and started on the process thread, so that the
+	// JACK bar start gets rolled exactly on the next Link quantum...
+	m_transport_req = (m_playing ? TransportStart : TransportStop);
+}
+
+
+void jack_link::osc_process ( jack_nframes_t nframes )
+{
+	const double quantum = std::max(m_quantum.load(), 1.0);
+	const auto session_state = m_link.captureAudioSessionState();
+	const auto host_time = m_link.clock().micros();
+	const auto period = jack_link::period(nframes);
+
+	const double tempo = session_state.tempo();
+	const bool playing = session_state.isPlaying();
+
+	// Schedule ahead, up to the end of the next period...
+	const double beat_now = session_state.beatAtTime(host_time, quantum);
+	const double beat_end = session_state.beatAtTime(
+		host_time + 2 * period, quantum);
+
+	// Missed or rewound beats start over from now...
+	if (m_osc_beat < beat_now - 1.0 || m_osc_beat > beat_end)
+		m_osc_beat = std::ceil(beat_now) - 1.0;
+
+	const bool tempo_changed = (std::abs(tempo - m_osc_tempo) > 0.001);
+	const bool beat_changed = (m_osc_beat + 1.0 <= beat_end);
+
+	if ((tempo_changed || beat_changed) && m_osc.begin()) {
+		if (tempo_changed) {
+			m_osc.bundle(m_osc.timetag(host_time));
+			m_osc.message("/link/tempo", tempo);
+			m_osc_tempo = tempo;
+		}
+		for (double beat = m_osc_beat + 1.0; beat <= beat_end; beat += 1.0) {
+			const auto beat_time = session_state.timeAtBeat(beat, quantum);
+			const double phase = beat - quantum * std::floor(beat / quantum);
+			m_osc.bundle(m_osc.timetag(beat_time));
+			if (phase < 0.5)
+				m_osc.message("/link/bar", beat, phase, tempo, quantum, playing);
+			m_osc.message("/link/beat", beat, phase, tempo, quantum, playing);
+			m_osc_beat = beat;
+		}
+		m_osc.end();
+	}
+
+	m_osc.notify();
+}
+
+
+void jack_link::state_process (
+	jack_transport_state_t state, jack_position_t *pos )
+{
+	const double quantum = std::max(m_quantum.load(), 1.0);
+	const auto session_state = m_link.captureAudioSessionState();
+	// Current cycle start frame, as heard...
+	const auto host_time = cycle_time() + m_period;
+
+	jack_link_cycle cycle;
+	::memset(&cycle.state, 0, sizeof(cycle.state));
+	cycle.state.tempo = session_state.tempo();
+	cycle.state.quantum = quantum;
+	cycle.state.beat = session_state.beatAtTime(host_time, quantum);
+	cycle.state.phase = session_state.phaseAtTime(host_time, quantum);
+	cycle.state.playing = (session_state.isPlaying() ? 1 : 0);
+	cycle.state.npeers = (unsigned int) m_npeers;
+	cycle.state.rolling = (Transport::rolling(state) ? 1 : 0);
+	cycle.state.frame = pos->frame;
+	cycle.state.srate = m_srate;
+
+	// Frame-beat tempo map: our own as timebase master (tempo ramps
+	// included), otherwise constant Link tempo from this cycle on...
+	if (m_timebase_master && !m_options.observer) {
+		tempo_map(cycle.tempo);
 	} else {
-		const double quantum
-			= std::max(m_quantum, 1.0);
-		const double beats
-			= m_tempo * pos->frame / (60.0 * pos->frame_rate);
-		return std::fmod(beats, quantum) - quantum;
+		cycle.tempo.anchor_frame = pos->frame;
+		cycle.tempo.tempo = cycle.state.tempo;
+		cycle.tempo.srate = m_srate;
+	}
+
+	m_state.store(cycle);
+}
+
+
+void jack_link::startup_mark ( std::atomic<int64_t>& mark )
+{
+	// First one only, whichever thread gets there...
+	int64_t unset = -1;
+	mark.compare_exchange_strong(unset,
+		(m_link.clock().micros() - m_startup_time).count());
+}
+
+
+void jack_link::startup_report (void)
+{
+	// Report each startup milestone once, as reached...
+	const struct { std::atomic<int64_t>& mark; const char *text; } marks[] = {
+		{ m_startup_jack,     "JACK client active" },
+		{ m_startup_timebase, "first timebase callback" },
+		{ m_startup_peer,     "first Link peer" }
+	};
+
+	unsigned int i = 0;
+	for (const auto& m : marks) {
+		const int64_t usecs = m.mark;
+		if (usecs >= 0 && (m_startup_reported & (1 << i)) == 0) {
+			jack_link_log("jack_link::startup(): %s after %.1f ms.",
+				m.text, 0.001 * usecs);
+			m_startup_reported |= (1 << i);
+		}
+		++i;
+	}
+}
+
+
+bool jack_link::schedule_parse ( const std::string& spec )
+{
+	if (m_options.observer)
+		return false;
+
+	std::istringstream iss(spec);
+	std::string when, command;
+	iss >> when;
+	if (!when.compare("at"))
+		iss >> when;
+
+	const double quantum = std::max(m_quantum.load(), 1.0);
+	double beat = 0.0;
+	if (!when.compare("next")) {
+		const auto session_state = m_link.captureAppSessionState();
+		const auto host_time = m_link.clock().micros();
+		beat = session_state.beatAtTime(host_time, quantum);
+		beat = quantum * (std::floor(beat / quantum) + 1.0);
+	}
+	else
+	if (!when.compare("bar")) {
+		double bar = 0.0;
+		if (!(iss >> bar))
+			when.clear();
+		beat = quantum * (bar - 1.0);
+	}
+	else
+	if (!(std::istringstream(when) >> beat))
+		when.clear();
+
+	int cmd = -1;
+	double value = 0.0;
+	iss >> command;
+	if (!command.compare("tempo") && (iss >> value) && value > 0.0)
+		cmd = ScheduleTempo;
+	else
+	if (!command.compare("start"))
+		cmd = ScheduleStart;
+	else
+	if (!command.compare("stop"))
+		cmd = ScheduleStop;
+	else
+	if (!command.compare("quantum") && (iss >> value) && value > 0.0)
+		cmd = ScheduleQuantum;
+
+	if (when.empty() || cmd < 0) {
+		jack_link_log("Invalid scheduled command: %s.", spec.c_str());
+		return false;
+	}
+
+	if (!schedule_post(beat, cmd, value)) {
+		jack_link_log("Too many scheduled commands: %s.", spec.c_str());
+		return false;
 	}
+
+	jack_link_log("jack_link::schedule(%g): %s", beat, spec.c_str());
+	return true;
 }
 
 
@@ -408,17 +1381,102 @@ void jack_link::worker_start (void)
 	m_running = true;
 
 	while (m_running) {
+		if (m_client == nullptr && m_options.supervised)
+			client_retry(lock);
 		worker_run();
-		m_cond.wait_for(lock, std::chrono::milliseconds(100));
+		const unsigned long events = m_worker_events;
+		if (m_client == nullptr && m_options.supervised) {
+			m_cond.wait_for(lock, m_client_retry);
+			continue;
+		}
+		if (worker_idle()) {
+			// Block until some Link, JACK transport or control event...
+			m_cond.wait(lock);
+		} else {
+			m_cond.wait_for(lock, m_worker_timeout);
+		}
+		// Woken up for nothing? (timeout or spurious, no event
+		// posted and nothing pending for the next run either)
+		if (m_running && m_worker_events == events && worker_idle())
+			++m_idle_wakeups;
 	}
 
 	jack_link_log(m_name + ": terminated.");
 }
 
 
+// Wake up the worker on some event (mutex locked).
+void jack_link::worker_notify (void)
+{
+	++m_worker_events;
+	m_cond.notify_one();
+}
+
+
+bool jack_link::worker_idle (void) const
+{
+	// No peers, nothing pending and JACK transport stopped...
+	if (m_client == nullptr)
+		return false;
+
+	// Offline render: woken up on return to realtime...
+	if (m_freewheel)
+		return true;
+
+	if (m_npeers > 0)
+		return false;
+
+	if (m_timebase_refresh || m_transport_req != TransportNone)
+		return false;
+
+	const jack_transport_state_t state
+		= Transport::query(m_client, nullptr);
+
+	return (!Transport::rolling(state) && !Transport::starting(state));
+}
+
+
+bool jack_link::tempo_follow ( double& tempo )
+{
+	tempo = m_follow_tempo;
+	if (tempo <= 0.0 || std::abs(m_tempo - tempo) <= m_options.tempo_hysteresis)
+		return false;
+
+	// Rate limited: whatever came in between gets coalesced...
+	const auto host_time = m_link.clock().micros();
+	const auto due_time = m_follow_commit + std::chrono::microseconds(
+		std::llround(1.0e6 / m_options.tempo_rate));
+	if (host_time < due_time) {
+		const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds> (
+			due_time - host_time) + std::chrono::milliseconds(1);
+		m_worker_timeout = std::min(m_worker_timeout, timeout);
+		return false;
+	}
+
+	m_follow_commit = host_time;
+
+	++m_tempo_commits;
+
+	return true;
+}
+
+
 void jack_link::worker_run (void)
 {
-	if (m_client && m_npeers > 0) {
+	m_worker_timeout = std::chrono::milliseconds(100);
+
+	startup_report();
+
+	if (m_client == nullptr || m_freewheel)
+		return;
+
+	jack_position_t pos;
+	const jack_transport_state_t state
+		= Transport::query(m_client, &pos);
+
+	timebase_check(state, &pos);
+
+	if (m_npeers > 0 && !m_options.observer) {
 
 		int request = 0;
 
@@ -426,15 +1484,12 @@ void jack_link::worker_run (void)
 		double beats_per_bar = 0.0;
 		bool playing_req = false;
 
-		jack_position_t pos;
-		const jack_transport_state_t state
-			= ::jack_transport_query(m_client, &pos);
-
 		const bool playing
-			= (state == JackTransportRolling
-			|| state == JackTransportLooping);
+			= Transport::rolling(state);
 
-		if ((playing && !m_playing) || (!playing && m_playing)) {
+		// Not while a quantum aligned start/stop is pending...
+		if (m_transport_req == TransportNone
+			&& ((playing && !m_playing) || (!playing && m_playing))) {
 			if (m_playing_req) {
 				m_playing_req = false;
 			} else {
@@ -443,11 +1498,11 @@ void jack_link::worker_run (void)
 			}
 		}
 
-		if (pos.valid & JackPositionBBT) {
-			if (std::abs(m_tempo - pos.beats_per_minute) > 0.01) {
-				beats_per_minute = pos.beats_per_minute;
+		if (Transport::bbt(&pos)) {
+			if (tempo_follow(beats_per_minute))
 				++request;
-			}
+			else
+				beats_per_minute = 0.0;
 			if (std::abs(m_quantum - pos.beats_per_bar) > 0.01) {
 				beats_per_bar = pos.beats_per_bar;
 				++request;
@@ -458,6 +1513,8 @@ void jack_link::worker_run (void)
 			auto session_state = m_link.captureAppSessionState();
 			const auto host_time = m_link.clock().micros();
 			if (beats_per_minute > 0.0) {
+				// Committed at the current host time, as any
+				// past one would have the Link beat jump now...
 				m_tempo = beats_per_minute;
 				session_state.setTempo(m_tempo, host_time);
 			}
@@ -496,230 +1553,4 @@ void jack_link::worker_stop (void)
 }
 
 
-// daemon mode stuff...
-//
-
-#include <sys/param.h>
-
-
-static bool daemon_started = false;
-
-
-void daemon_fork (void)
-{
-	const int pid = ::fork();
-	if (pid > 0)
-		::exit(0);
-	else 
-	if (pid < 0)
-		::exit(1);
-}
-
-
-void daemon_start (void)
-{
-	daemon_fork();
-
-	::setsid();
-
-	daemon_fork();
-
-	for(int fd = 0; fd < NOFILE; ++fd)
-		::close(fd);
-	
-	::chdir("/tmp");
-	::umask(0);
-
-	daemon_started = true;
-}
-
-
-// main line stuff...
-//
-
-void sig_handler ( int sig_no )
-{
-	if (daemon_started) {
-		jack_link_log("Daemon is terminating with signal %d (SIG%s).", sig_no, ::sigabbrev_np(sig_no));
-		daemon_started = false;
-	//	::exit(sig_no);
-	} else {
-		::fclose(stdin);
-		std::cerr << std::endl;
-	}
-}
-
-
-void trim_ws ( std::string& s )
-{
-	const char *ws = " \t\n\r";
-	const std::string::size_type first
-		= s.find_first_not_of(ws);
-	if (first != std::string::npos)
-		s.erase(0, first);
-	const std::string::size_type last
-		= s.find_last_not_of(ws);
-	if (last != std::string::npos)
-		s.erase(last + 1);
-	else
-		s.clear();
-}
-
-
-void version (void)
-{
-	jack_link_log(JACK_LINK_NAME " v" JACK_LINK_VERSION " (Link v" ABLETON_LINK_VERSION ")");
-}
-
-
-void usage (void)
-{
-	std::cout << std::endl;
-	std::cout << "Usage: " << JACK_LINK_NAME << " [options]" << std::endl;
-	std::cout << std::endl;
-	std::cout << "Options:" << std::endl;
-	std::cout << std::endl;
-	std::cout << "  -n, --name <name>" << std::endl;
-	std::cout << "\tClient name (default = '" JACK_LINK_NAME "')" << std::endl;
-	std::cout << std::endl;
-	std::cout << "  -q, --quiet" << std::endl;
-	std::cout << "\tRun as quiet as a daemon (default = no)" << std::endl;
-	std::cout << std::endl;
-	std::cout << "  -d, --daemon" << std::endl;
-	std::cout << "\tRun in the background as a daemon (default = no)" << std::endl;
-	std::cout << std::endl;
-	std::cout << "  -h, --help" << std::endl;
-	std::cout << "\tShow this help about command line options" << std::endl;
-	std::cout << std::endl;
-}
-
-
-int main ( int argc, char **argv )
-{
-	::signal(SIGABRT, &sig_handler);
-	::signal(SIGHUP,  &sig_handler);
-	::signal(SIGINT,  &sig_handler);
-	::signal(SIGQUIT, &sig_handler);
-	::signal(SIGTERM, &sig_handler);
-
-	std::string name = JACK_LINK_NAME;
-	bool quiet = false;
-	bool daemon = false;
-
-	for (int i = 1; i < argc; ++i) {
-		const std::string arg = argv[i];
-		if (!arg.compare("-n") || !arg.compare("--name")) {
-			if (++i < argc) {
-				name = argv[i];
-				if (name.empty()) {
-					std::cerr << "Invalid empty name" << std::endl;
-					return 2;
-				}
-			}
-		}
-		else
-		if (!arg.compare("-q") || !arg.compare("--quiet")) {
-			quiet = true;
-		}
-		else
-		if (!arg.compare("-d") || !arg.compare("--daemon")) {
-			daemon = true;
-		}
-		else
-		if (!arg.compare("-h") || !arg.compare("--help")) {
-			usage();
-			return 1;
-		}
-	}
-
-	jack_link_log logger;
-
-	if (daemon)
-		daemon_start();
-
-	if (daemon_started) {
-		logger.start(JACK_LINK_NAME, name);
-		jack_link_log("Daemon is starting with PID %u...", ::getpid());
-	}
-
-	if (!quiet)
-		version();
-
-	jack_link app(name);
-
-	// Enter daemon loop (background)...
-	//
-	if (daemon) {
-		while (daemon_started)
-			::sleep(1);
-		app.terminate();
-		jack_link_log("Daemon terminated.");
-		logger.stop();
-		return 0;
-	}
-
-	// Enter interactive loop (foreground)...
-	//
-	std::string line, arg;
-
-	while (!std::cin.eof() && app.active()) {
-		if (!quiet)
-			std::cout << app.name() << "> ";
-		std::getline(std::cin, line);
-		trim_ws(line);
-		std::transform(
-			line.begin(), line.end(),
-			line.begin(), ::tolower);
-		arg.clear();
-		const std::string::size_type pos
-			= line.find_first_of(' ');
-		if (pos != std::string::npos) {
-			arg = line.substr(pos + 1);
-			line.erase(pos);
-			trim_ws(arg);
-		}
-		if (!line.compare("quit") || !line.compare("exit"))
-			break;
-		if (!line.compare("start"))
-			app.playing(true);
-		else
-		if (!line.compare("stop"))
-			app.playing(false);
-		else
-		if (!line.compare("tempo")) {
-			double bpm = 0.0;
-			std::istringstream(arg) >> bpm;
-			if (bpm > 0.0)
-				app.tempo(bpm);
-			else
-				std::cout << "tempo: " << app.tempo() << std::endl;
-		}
-		else
-		if (!line.compare("status")) {
-			std::cout << "name: "    << app.name()    << std::endl;
-			std::cout << "npeers: "  << app.npeers()  << std::endl;
-			std::cout << "srate: "   << app.srate()   << std::endl;
-			std::cout << "tempo: "   << app.tempo()   << std::endl;
-			std::cout << "quantum: " << app.quantum() << std::endl;
-			std::cout << "playing: " <<
-				(app.playing() ? "started" : "stopped") << std::endl;
-		}
-		else
-		if (!line.compare("version"))
-			version();
-		else
-		if (!line.compare("help")) {
-			std::cout << "help | start | stop";
-			std::cout << " | tempo [bpm] | status";
-			std::cout << " | version | quit | exit" << std::endl;
-		}
-		else
-		if (!line.empty())
-			std::cout << "?Invalid command." << std::endl;
-	}
-
-	return 0;
-}
-
-
 // end of jack_link.cpp
@@ -0,0 +1,123 @@
+/* jack_link.h
+ */
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __jack_link_h
+#define __jack_link_h
+
+#include <jack/jack.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*
+ * libjack_link -- embeddable JACK transport/Ableton Link bridge (C API).
+ *
+ * A bridge is created on an existing JACK client, owned by the host,
+ * taking the same options as the jack_link command line (eg. "--osc 9000").
+ *
+ * By default the bridge installs its own process callback, so the client
+ * must not be active yet. Hosts sharing an already active client pass
+ * JACK_LINK_PROCESS_HOOK instead and call jack_link_process() from
+ * their own process callback, every cycle, until jack_link_destroy(),
+ * forwarding their own freewheel, xrun, buffer size and sample rate
+ * notifications as well.
+ *
+ * On jack_link_destroy(), a bridge with its own process callback
+ * deactivates the client and unregisters all of its callbacks; the
+ * client is left inactive, for the host to close or reuse. With
+ * JACK_LINK_PROCESS_HOOK the client stays active: a jack_link_process()
+ * call still in progress is waited for and further ones return right
+ * away while it runs, but none may be made (nor any notification) once
+ * jack_link_destroy() has returned.
+ */
+
+#define JACK_LINK_API_VERSION 1
+
+typedef struct _jack_link jack_link_t;
+
+/* Creation flags. */
+#define JACK_LINK_PROCESS_HOOK 0x1
+
+/* State snapshot: lock-free, consistent as of the last process cycle. */
+typedef struct _jack_link_state
+{
+	double tempo;           /* Link session tempo (bpm) */
+	double quantum;         /* Link quantum (beats per bar) */
+	double beat;            /* Link beat, at cycle start */
+	double phase;           /* Link phase in quantum, at cycle start */
+	int playing;            /* Link start/stop state */
+	unsigned int npeers;    /* Link session peers */
+	int rolling;            /* JACK transport rolling */
+	jack_nframes_t frame;   /* JACK transport frame */
+	double srate;           /* JACK sample rate (Hz) */
+
+} jack_link_state_t;
+
+
+const char *jack_link_version (void);
+
+jack_link_t *jack_link_create (
+	jack_client_t *client, const char *options, int flags);
+
+void jack_link_destroy (jack_link_t *link);
+
+/* Real-time safe, only with JACK_LINK_PROCESS_HOOK. */
+int jack_link_process (jack_link_t *link, jack_nframes_t nframes);
+
+/* Host notifications, only with JACK_LINK_PROCESS_HOOK. */
+void jack_link_freewheel (jack_link_t *link, int starting);
+void jack_link_xrun (jack_link_t *link);
+void jack_link_buffer_size (jack_link_t *link, jack_nframes_t nframes);
+void jack_link_sample_rate (jack_link_t *link, jack_nframes_t srate);
+
+/* Beat-scheduled command ("[at] <when> <command> [<value>]"),
+ * as the --at command line option; returns 0 on success. */
+int jack_link_schedule (jack_link_t *link, const char *spec);
+
+void jack_link_set_tempo (jack_link_t *link, double tempo);
+void jack_link_set_playing (jack_link_t *link, int playing);
+
+/* Real-time safe, wait-free for the process thread: copies at most
+ * size bytes (ie. sizeof(jack_link_state_t)) of the latest snapshot;
+ * returns 0 on success. */
+int jack_link_get_state (
+	jack_link_t *link, jack_link_state_t *state, size_t size);
+
+/* Batch JACK transport frame to/from Link beat (and phase) conversions,
+ * all against the one latest snapshot and its tempo map (tempo ramps
+ * included, as timebase master); real-time safe (phases may be
+ * NULL); return 0 on success, -1 when no snapshot is available yet. */
+int jack_link_frames_to_beats (jack_link_t *link,
+	const jack_nframes_t *frames, double *beats, double *phases, size_t n);
+
+int jack_link_beats_to_frames (jack_link_t *link,
+	const double *beats, jack_nframes_t *frames, size_t n);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __jack_link_h */
+
+/* end of jack_link.h */
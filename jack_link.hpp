@@ -50,17 +50,191 @@
 
 #include <jack/jack.h>
 
+#include "jack_link.h"
+
+#include "jack_link_jack.hpp"
+#include "jack_link_core.hpp"
+#include "jack_link_osc.hpp"
+#include "jack_link_ltc.hpp"
+#include "jack_link_control.hpp"
+
 #include <string>
+#include <vector>
+#include <ostream>
 #include <chrono>
+#include <atomic>
 #include <mutex>
 #include <thread>
+#include <condition_variable>
+
+#include <cstring>
+#include <cstdint>
+
+
+//---------------------------------------------------------------------
+// jack_link_options -- bridge options.
+//
+
+struct jack_link_options
+{
+	// Keep Link session while retrying lost JACK connections.
+	bool supervised = false;
+
+	// Observer (shadow) mode: never take timebase nor transport.
+	bool observer = false;
+
+	// OSC beat/phase broadcast destination ("[host:]port").
+	std::string osc;
+
+	// LTC output frame rate ("24", "25", "29.97" or "30").
+	std::string ltc;
+
+	// JACK tempo follower: Link update rate (Hz) and hysteresis (bpm).
+	double tempo_rate = 10.0;
+	double tempo_hysteresis = 0.01;
+
+	// Tempo change ramps: length (beats, zero for none) and curve
+	// ("linear" or "exponential").
+	double ramp = 0.0;
+	std::string ramp_curve = "linear";
+
+	// Beat-scheduled commands ("[at] <when> <command> [<value>]").
+	std::vector<std::string> schedule;
+
+	// Host calls process() from its own process callback (shared client).
+	bool process_hook = false;
+
+	// Runtime control named pipe (FIFO) path, none if empty.
+	std::string control;
+
+	// Parse command line option (and argument).
+	bool parse(int& i, int argc, char **argv);
+
+	// Parse options string (eg. internal client load init).
+	void parse(const std::string& args);
+};
+
+
+//---------------------------------------------------------------------
+// jack_link_stats -- monitoring counters (snapshot).
+//
+
+struct jack_link_stats
+{
+	// JACK transport relocations propagated to Link.
+	unsigned long relocations = 0;
+
+	// Tempo map resyncs to Link (after xruns, buffer size changes...).
+	unsigned long resyncs = 0;
+
+	// Worker wake-ups while idle, with nothing to do.
+	unsigned long idle_wakeups = 0;
+
+	// JACK tempo changes committed to Link (tempo follower).
+	unsigned long tempo_commits = 0;
+
+	// JACK freewheel (offline render) runs.
+	unsigned long freewheels = 0;
+
+	// JACK xruns, buffer size and sample rate changes (re-anchored).
+	unsigned long xruns = 0;
+	unsigned long buffer_size_changes = 0;
+	unsigned long srate_changes = 0;
+
+	// Startup timing (msecs since initialize; negative until reached).
+	double startup_jack = -1.0;
+	double startup_timebase = -1.0;
+	double startup_peer = -1.0;
+
+	// Observer mode cycles and BBT divergence (beats), as would be
+	// published against the actual JACK transport and Link timeline.
+	unsigned long observed = 0;
+	double jack_divergence = 0.0;
+	double jack_divergence_max = 0.0;
+	double jack_divergence_avg = 0.0;
+	double link_divergence = 0.0;
+	double link_divergence_max = 0.0;
+	double link_divergence_avg = 0.0;
+};
+
+
+//---------------------------------------------------------------------
+// jack_link_snapshot -- lock-free state (seqlock, single writer).
+//
+
+template <typename T>
+class jack_link_snapshot
+{
+public:
+
+	jack_link_snapshot() : m_seq(0)
+		{ for (auto& w : m_data) w.store(0, std::memory_order_relaxed); }
+
+	// Writer (real-time safe, never waits).
+	void store(const T& value)
+	{
+		uint64_t data[c_words] = { 0 };
+		::memcpy(data, &value, sizeof(T));
+		const unsigned int seq = m_seq.load(std::memory_order_relaxed);
+		m_seq.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (std::size_t i = 0; i < c_words; ++i)
+			m_data[i].store(data[i], std::memory_order_relaxed);
+		m_seq.store(seq + 2, std::memory_order_release);
+	}
+
+	// Readers (retry while a store is in progress).
+	T load() const
+	{
+		uint64_t data[c_words];
+		unsigned int seq1, seq2;
+		do {
+			seq1 = m_seq.load(std::memory_order_acquire);
+			for (std::size_t i = 0; i < c_words; ++i)
+				data[i] = m_data[i].load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			seq2 = m_seq.load(std::memory_order_relaxed);
+		} while ((seq1 & 1) || seq1 != seq2);
+		T value;
+		::memcpy(&value, data, sizeof(T));
+		return value;
+	}
+
+private:
+
+	static const std::size_t c_words = (sizeof(T) + 7) / 8;
+
+	std::atomic<unsigned int> m_seq;
+	std::atomic<uint64_t> m_data[c_words];
+};
+
 
+//---------------------------------------------------------------------
+// jack_link_cycle -- per cycle state and tempo map (snapshot).
+//
+
+struct jack_link_cycle
+{
+	jack_link_state_t state;
+	jack_link_tempo tempo;
+};
+
+
+//---------------------------------------------------------------------
+// jack_link -- decl.
+//
 
-class jack_link
+class jack_link : public jack_link_core<jack_link_jack, ableton::Link>
 {
 public:
 
-	jack_link(const std::string& name);
+	jack_link(const std::string& name,
+		const jack_link_options& options = jack_link_options());
+
+	// Constructor (existing client, eg. internal client)
+	jack_link(jack_client_t *client,
+		const jack_link_options& options = jack_link_options());
+
 	~jack_link();
 
 	const std::string& name() const;
@@ -80,32 +254,75 @@ public:
 	void playing(bool playing);
 	bool playing() const;
 
+	jack_link_stats stats() const;
+
+	// Beat-scheduled commands ("[at] <when> <command> [<value>]"),
+	// where <when> is a Link beat, "bar <n>" or "next" (downbeat) and
+	// <command> is "tempo <bpm>", "start", "stop" or "quantum <beats>".
+	bool schedule(const std::string& spec);
+
+	// Interactive/control commands (eg. "tempo 128", "help"),
+	// replies written out; false on "quit" or "exit".
+	bool command(const std::string& cmd, std::ostream& out);
+
+	// Lock-free state snapshot (as of the last process cycle start).
+	jack_link_state_t state() const;
+
+	// Batch frame/beat conversions (real-time safe, one snapshot each).
+	bool frames_to_beats(const jack_nframes_t *frames,
+		double *beats, double *phases, std::size_t n) const;
+	bool beats_to_frames(const double *beats,
+		jack_nframes_t *frames, std::size_t n) const;
+
+	// Process hook (real-time safe, shared client).
+	int process(jack_nframes_t nframes);
+
+	// Host notifications (shared client).
+	void freewheel(int starting);
+	void xrun();
+	void buffer_size(jack_nframes_t nframes);
+	void srate(jack_nframes_t srate);
+
 protected:
 
+	// JACK transport backend (policy), all the way through.
+	typedef jack_link_jack Transport;
+
+	jack_link(const std::string& name,
+		const jack_link_options& options,
+		jack_client_t *client);
+
 	static int process_callback(
 		jack_nframes_t nframes,
 		void *user_data);
 
+	int process_callback(jack_nframes_t nframes);
+
+	bool process_enter();
+	void process_leave();
+
 	static int sync_callback(
 		jack_transport_state_t state,
 		jack_position_t *pos,
 		void *user_data);
 
-	int sync_callback(
-		jack_transport_state_t state,
-		jack_position_t *pos);
-
 	static void timebase_callback(
 		jack_transport_state_t state,
 		jack_nframes_t nframes,
 		jack_position_t *pos,
 		int new_pos, void *user_data);
 
-	void timebase_callback(
-		jack_transport_state_t state,
-		jack_nframes_t nframes,
-		jack_position_t *pos,
-		int new_pos);
+	static void freewheel_callback(int starting, void *user_data);
+
+	void freewheel_callback(int starting);
+
+	static int xrun_callback(void *user_data);
+	static int buffer_size_callback(jack_nframes_t nframes, void *user_data);
+	static int srate_callback(jack_nframes_t srate, void *user_data);
+
+	int xrun_callback();
+	int buffer_size_callback(jack_nframes_t nframes);
+	int srate_callback(jack_nframes_t srate);
 
 	static void on_shutdown(void *user_data);
 
@@ -115,30 +332,83 @@ protected:
 	void tempo_callback(const double tempo);
 	void playing_callback(const bool playing);
 
+	jack_client_t *client_connect(jack_options_t options, bool verbose);
+	void client_setup();
+	void client_close();
+	void client_retry(std::unique_lock<std::mutex>& lock);
+	void client_restore();
+
 	void timebase_reset();
+	void timebase_refresh();
+	void timebase_check(jack_transport_state_t state, jack_position_t *pos);
 	void transport_reset();
+	void transport_schedule();
+
+	bool tempo_follow(double& tempo);
+
+	void osc_process(jack_nframes_t nframes);
+
+	void state_process(jack_transport_state_t state, jack_position_t *pos);
+
+	bool schedule_parse(const std::string& spec);
+
+	void control_command(const std::string& cmd);
 
-	double position_beat(jack_position_t *pos) const;
+	void startup_mark(std::atomic<int64_t>& mark);
+	void startup_report();
 
 	void worker_start();
+	void worker_notify();
+	bool worker_idle() const;
 	void worker_run();
 	void worker_stop();
 
 private:
 
 	std::string m_name;
-	ableton::Link m_link;
-	jack_client_t *m_client;
-	double m_srate;
-	unsigned long m_timebase;
+	jack_link_options m_options;
+	bool m_client_extern;
+	jack_client_t *m_client_lost;
+	std::chrono::milliseconds m_client_retry;
+	unsigned long m_timebase_last;
+	jack_nframes_t m_timebase_frame;
+	std::atomic<bool> m_timebase_master;
+	bool m_timebase_lost;
+	std::chrono::microseconds m_timebase_retry;
+	bool m_timebase_refresh;
+	std::chrono::microseconds m_timebase_refresh_time;
 	std::size_t m_npeers;
-	double m_tempo, m_tempo_req;
-	double m_quantum;
-	bool m_playing, m_playing_req;
 	bool m_running;
 	std::thread *m_thread;
+	jack_transport_state_t m_worker_state;
+	bool m_worker_notify;
+	bool m_worker_freewheel;
+	std::chrono::milliseconds m_worker_timeout;
+	unsigned long m_worker_events;
+	std::atomic<unsigned long> m_idle_wakeups;
+	std::atomic<double> m_follow_tempo;
+	std::chrono::microseconds m_follow_commit;
+	std::atomic<unsigned long> m_tempo_commits;
+	std::atomic<unsigned long> m_freewheels;
+	std::atomic<unsigned long> m_xruns;
+	std::atomic<unsigned long> m_buffer_size_changes;
+	std::atomic<unsigned long> m_srate_changes;
 	std::mutex m_mutex;
 	std::condition_variable m_cond;
+	jack_link_osc m_osc;
+	double m_osc_beat;
+	double m_osc_tempo;
+	jack_link_ltc m_ltc;
+	jack_port_t *m_ltc_port;
+	jack_link_control m_control;
+	jack_link_snapshot<jack_link_cycle> m_state;
+	std::chrono::microseconds m_startup_time;
+	std::atomic<int64_t> m_startup_jack;
+	std::atomic<int64_t> m_startup_timebase;
+	std::atomic<int64_t> m_startup_peer;
+	unsigned int m_startup_reported;
+	std::atomic<bool> m_process_closing;
+	std::atomic<int> m_process_refs;
 };
 
 
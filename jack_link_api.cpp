@@ -0,0 +1,155 @@
+// jack_link_api.cpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "jack_link.h"
+
+#include "jack_link.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+// C API stuff...
+//
+// A jack_link_t handle is the jack_link instance itself.
+//
+
+static inline jack_link *jack_link_cast ( jack_link_t *link )
+{
+	return reinterpret_cast<jack_link *> (link);
+}
+
+
+const char *jack_link_version (void)
+{
+	return JACK_LINK_VERSION;
+}
+
+
+jack_link_t *jack_link_create (
+	jack_client_t *client, const char *options, int flags )
+{
+	if (client == nullptr)
+		return nullptr;
+
+	jack_link_options opts;
+	opts.parse(options ? options : "");
+
+	// The host owns the client, stays up as long as it does...
+	opts.supervised = false;
+	opts.process_hook = (flags & JACK_LINK_PROCESS_HOOK);
+
+	jack_link *app = new jack_link(client, opts);
+	if (!app->active()) {
+		delete app;
+		return nullptr;
+	}
+
+	return reinterpret_cast<jack_link_t *> (app);
+}
+
+
+void jack_link_destroy ( jack_link_t *link )
+{
+	delete jack_link_cast(link);
+}
+
+
+int jack_link_process ( jack_link_t *link, jack_nframes_t nframes )
+{
+	return jack_link_cast(link)->process(nframes);
+}
+
+
+void jack_link_freewheel ( jack_link_t *link, int starting )
+{
+	jack_link_cast(link)->freewheel(starting);
+}
+
+
+void jack_link_xrun ( jack_link_t *link )
+{
+	jack_link_cast(link)->xrun();
+}
+
+
+void jack_link_buffer_size ( jack_link_t *link, jack_nframes_t nframes )
+{
+	jack_link_cast(link)->buffer_size(nframes);
+}
+
+
+void jack_link_sample_rate ( jack_link_t *link, jack_nframes_t srate )
+{
+	jack_link_cast(link)->srate(srate);
+}
+
+
+void jack_link_set_tempo ( jack_link_t *link, double tempo )
+{
+	jack_link_cast(link)->tempo(tempo);
+}
+
+
+void jack_link_set_playing ( jack_link_t *link, int playing )
+{
+	jack_link_cast(link)->playing(playing != 0);
+}
+
+
+int jack_link_schedule ( jack_link_t *link, const char *spec )
+{
+	if (spec == nullptr)
+		return -1;
+
+	return (jack_link_cast(link)->schedule(spec) ? 0 : -1);
+}
+
+
+int jack_link_get_state (
+	jack_link_t *link, jack_link_state_t *state, size_t size )
+{
+	if (state == nullptr)
+		return -1;
+
+	// Older (smaller) structs get what they know about...
+	const jack_link_state_t snapshot = jack_link_cast(link)->state();
+	::memcpy(state, &snapshot, std::min(size, sizeof(snapshot)));
+
+	return 0;
+}
+
+
+int jack_link_frames_to_beats ( jack_link_t *link,
+	const jack_nframes_t *frames, double *beats, double *phases, size_t n )
+{
+	return (jack_link_cast(link)->frames_to_beats(frames, beats, phases, n) ? 0 : -1);
+}
+
+
+int jack_link_beats_to_frames ( jack_link_t *link,
+	const double *beats, jack_nframes_t *frames, size_t n )
+{
+	return (jack_link_cast(link)->beats_to_frames(beats, frames, n) ? 0 : -1);
+}
+
+
+// end of jack_link_api.cpp
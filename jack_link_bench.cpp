@@ -0,0 +1,146 @@
+// jack_link_bench.cpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "jack_link_convert.hpp"
+
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include <cstdio>
+#include <cstring>
+
+
+// Batch frame/beat conversion kernels benchmark (see "make bench"):
+// default (SSE2, where available) against the scalar ones, over a
+// constant tempo map and a tempo ramp in progress alike.
+//
+
+static const std::size_t c_frames = 4096;
+static const unsigned int c_runs = 2000;
+
+
+//---------------------------------------------------------------------
+// jack_link_bench -- kernel throughput (conversions per nsec).
+//
+
+template <typename Func>
+static double bench_rate ( Func func )
+{
+	const auto t0 = std::chrono::steady_clock::now();
+	for (unsigned int run = 0; run < c_runs; ++run)
+		func();
+	const auto t1 = std::chrono::steady_clock::now();
+	const double nsecs = double(
+		std::chrono::duration_cast<std::chrono::nanoseconds> (t1 - t0).count());
+	return double(c_runs * c_frames) / std::max(nsecs, 1.0);
+}
+
+
+static void bench_run ( const char *name,
+	const jack_link_state_t& state, const jack_link_tempo& tempo )
+{
+	const jack_link_convert convert(state, tempo);
+
+	std::vector<jack_nframes_t> frames(c_frames);
+	std::vector<jack_nframes_t> frames1(c_frames), frames2(c_frames);
+	std::vector<double> beats(c_frames);
+	std::vector<double> beats1(c_frames), beats2(c_frames);
+	std::vector<double> phases1(c_frames), phases2(c_frames);
+
+	for (std::size_t i = 0; i < c_frames; ++i) {
+		frames[i] = state.frame + jack_nframes_t(i * 64);
+		beats[i] = state.beat + double(i) / 64.0;
+	}
+
+	const double f2b = bench_rate([&] () {
+		convert.frames_to_beats(frames.data(),
+			beats1.data(), phases1.data(), c_frames); });
+	const double f2b_scalar = bench_rate([&] () {
+		convert.frames_to_beats_scalar(frames.data(),
+			beats2.data(), phases2.data(), c_frames); });
+	const double b2f = bench_rate([&] () {
+		convert.beats_to_frames(beats.data(), frames1.data(), c_frames); });
+	const double b2f_scalar = bench_rate([&] () {
+		convert.beats_to_frames_scalar(beats.data(), frames2.data(), c_frames); });
+
+	// Kernels must agree...
+	double beats_diff = 0.0;
+	long frames_diff = 0;
+	for (std::size_t i = 0; i < c_frames; ++i) {
+		beats_diff = std::max(beats_diff, std::abs(beats1[i] - beats2[i]));
+		beats_diff = std::max(beats_diff, std::abs(phases1[i] - phases2[i]));
+		frames_diff = std::max(frames_diff,
+			std::abs(long(int32_t(frames1[i] - frames2[i]))));
+	}
+
+	::printf("%-8s frames_to_beats %6.3f /ns (scalar %6.3f /ns)"
+		"  beats_to_frames %6.3f /ns (scalar %6.3f /ns)"
+		"  max diff %g beats, %ld frames\n",
+		name, f2b, f2b_scalar, b2f, b2f_scalar, beats_diff, frames_diff);
+}
+
+
+//---------------------------------------------------------------------
+// main.
+//
+
+int main ( int /*argc*/, char ** /*argv*/ )
+{
+	jack_link_state_t state;
+	::memset(&state, 0, sizeof(state));
+	state.tempo = 120.0;
+	state.quantum = 4.0;
+	state.beat = 1234.5;
+	state.frame = 48000 * 60;
+	state.srate = 48000.0;
+
+	// Constant tempo...
+	jack_link_tempo tempo;
+	tempo.anchor_frame = state.frame;
+	tempo.tempo = state.tempo;
+	tempo.srate = state.srate;
+
+	bench_run("constant", state, tempo);
+
+	// Tempo ramp in progress, 120 to 140 bpm over 8 beats...
+	tempo.ramp = 1;
+	tempo.ramp_frame = state.frame;
+	tempo.ramp_tempo0 = 120.0;
+	tempo.ramp_tempo1 = 140.0;
+	tempo.ramp_length = 8.0;
+
+	for (int curve : { jack_link_tempo::RampLinear, jack_link_tempo::RampExponential }) {
+		const double secs = jack_link_tempo::ramp_curve_secs(curve,
+			tempo.ramp_tempo0, tempo.ramp_tempo1,
+			tempo.ramp_length, tempo.ramp_length);
+		tempo.ramp_curve = curve;
+		tempo.ramp_frames = jack_nframes_t(std::llround(secs * state.srate));
+		bench_run(curve == jack_link_tempo::RampExponential
+			? "exp" : "linear", state, tempo);
+	}
+
+	return 0;
+}
+
+
+// end of jack_link_bench.cpp
@@ -0,0 +1,167 @@
+// jack_link_control.cpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+
+#include "jack_link_control.hpp"
+
+#include "jack_link_log.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+//---------------------------------------------------------------------
+// jack_link_control -- impl.
+//
+
+// Command lines are truncated beyond this length.
+static const std::size_t c_line_max = 1024;
+
+
+// Constructor.
+jack_link_control::jack_link_control (void) :
+	m_created(false), m_fd(-1), m_pipe{-1, -1}, m_thread(nullptr)
+{
+}
+
+
+// Destructor.
+jack_link_control::~jack_link_control (void)
+{
+	close();
+}
+
+
+// Open/close named pipe (created when missing).
+bool jack_link_control::open (
+	const std::string& path, const handler& func )
+{
+	close();
+
+	m_created = (::mkfifo(path.c_str(), 0600) == 0);
+	if (!m_created && errno != EEXIST) {
+		jack_link_log("Could not create control pipe: %s (%s).",
+			path.c_str(), ::strerror(errno));
+		return false;
+	}
+
+	struct stat st;
+	if (::stat(path.c_str(), &st) < 0 || !S_ISFIFO(st.st_mode)) {
+		jack_link_log("Not a control pipe: %s.", path.c_str());
+		return false;
+	}
+
+	// Read-write, so that it never hangs up on writers closing...
+	m_fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+	if (m_fd < 0 || ::pipe(m_pipe) < 0) {
+		jack_link_log("Could not open control pipe: %s (%s).",
+			path.c_str(), ::strerror(errno));
+		m_path = path;
+		close();
+		return false;
+	}
+
+	m_path = path;
+	m_handler = func;
+	m_thread = new std::thread([this]{ reader_start(); });
+
+	jack_link_log("Control pipe: %s.", m_path.c_str());
+
+	return true;
+}
+
+
+void jack_link_control::close (void)
+{
+	if (m_thread) {
+		const char c = 0;
+		if (::write(m_pipe[1], &c, 1) < 0)
+			jack_link_log("Could not stop control reader.");
+		m_thread->join();
+		delete m_thread;
+		m_thread = nullptr;
+	}
+
+	for (int& fd : m_pipe) {
+		if (fd >= 0) {
+			::close(fd);
+			fd = -1;
+		}
+	}
+
+	if (m_fd >= 0) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+
+	if (m_created) {
+		::unlink(m_path.c_str());
+		m_created = false;
+	}
+
+	m_path.clear();
+}
+
+
+// Reader thread.
+void jack_link_control::reader_start (void)
+{
+	std::string line;
+	char buf[256];
+
+	for (;;) {
+		struct pollfd fds[2];
+		fds[0].fd = m_fd;
+		fds[0].events = POLLIN;
+		fds[1].fd = m_pipe[0];
+		fds[1].events = POLLIN;
+		if (::poll(fds, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		if (fds[1].revents)
+			break;
+		if ((fds[0].revents & POLLIN) == 0)
+			continue;
+		ssize_t n;
+		while ((n = ::read(m_fd, buf, sizeof(buf))) > 0) {
+			for (ssize_t i = 0; i < n; ++i) {
+				if (buf[i] != '\n') {
+					if (line.size() < c_line_max)
+						line += buf[i];
+					continue;
+				}
+				m_handler(line);
+				line.clear();
+			}
+		}
+	}
+}
+
+
+// end of jack_link_control.cpp
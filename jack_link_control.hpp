@@ -0,0 +1,74 @@
+// jack_link_control.hpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <string>
+#include <functional>
+#include <thread>
+
+
+//---------------------------------------------------------------------
+// jack_link_control -- decl.
+//
+// Runtime control channel: command lines read from a named pipe (FIFO)
+// on a reader thread, one per line (eg. echo "tempo 128" > <path>).
+//
+
+class jack_link_control
+{
+public:
+
+	// Command line handler (reader thread).
+	typedef std::function<void (const std::string&)> handler;
+
+	// Constructor.
+	jack_link_control();
+
+	// Destructor.
+	~jack_link_control();
+
+	// Open/close named pipe (created when missing).
+	bool open(const std::string& path, const handler& func);
+	void close();
+
+	bool active() const { return (m_fd >= 0); }
+
+	const std::string& path() const { return m_path; }
+
+protected:
+
+	// Reader thread.
+	void reader_start();
+
+private:
+
+	std::string m_path;
+	bool m_created;
+	int m_fd;
+	int m_pipe[2];
+	handler m_handler;
+	std::thread *m_thread;
+};
+
+
+// end of jack_link_control.hpp
@@ -0,0 +1,165 @@
+// jack_link_convert.cpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "jack_link_convert.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+//---------------------------------------------------------------------
+// jack_link_convert -- impl.
+//
+
+// Constructor.
+jack_link_convert::jack_link_convert (
+	const jack_link_state_t& state, const jack_link_tempo& tempo ) :
+	m_tempo(tempo), m_tempo_beat(0.0),
+	m_frame(state.frame), m_beat(state.beat),
+	m_quantum(std::max(state.quantum, 1.0)), m_quantum_inv(1.0 / m_quantum),
+	m_beats_per_frame(0.0), m_frames_per_beat(0.0)
+{
+	if (tempo.tempo > 0.0 && tempo.srate > 0.0) {
+		m_beats_per_frame = tempo.tempo / (60.0 * tempo.srate);
+		m_frames_per_beat = 1.0 / m_beats_per_frame;
+		m_tempo_beat = m_tempo.beats(m_frame);
+	}
+}
+
+
+// JACK transport frames to Link beats and phases (optional).
+void jack_link_convert::frames_to_beats ( const jack_nframes_t *frames,
+	double *beats, double *phases, std::size_t n ) const
+{
+	std::size_t i = 0;
+
+#if defined(__SSE2__)
+	// Tempo ramps: scalar kernels only...
+	const std::size_t m = (m_tempo.ramp ? 0 : n);
+
+	const __m128i frame0 = _mm_set1_epi32(int32_t(m_frame));
+	const __m128d beat0 = _mm_set1_pd(m_beat);
+	const __m128d bpf = _mm_set1_pd(m_beats_per_frame);
+	const __m128d q = _mm_set1_pd(m_quantum);
+	const __m128d qinv = _mm_set1_pd(m_quantum_inv);
+	const __m128d one = _mm_set1_pd(1.0);
+
+	// Phase: beat - quantum * floor(beat / quantum)...
+	auto phase = [q, qinv, one] ( __m128d b ) {
+		const __m128d x = _mm_mul_pd(b, qinv);
+		__m128d t = _mm_cvtepi32_pd(_mm_cvttpd_epi32(x));
+		t = _mm_sub_pd(t, _mm_and_pd(_mm_cmpgt_pd(t, x), one));
+		return _mm_sub_pd(b, _mm_mul_pd(t, q));
+	};
+
+	for (; i + 4 <= m; i += 4) {
+		// Signed frame deltas (wrap-around safe)...
+		const __m128i d = _mm_sub_epi32(
+			_mm_loadu_si128(reinterpret_cast<const __m128i *> (frames + i)),
+			frame0);
+		const __m128d d0 = _mm_cvtepi32_pd(d);
+		const __m128d d1 = _mm_cvtepi32_pd(_mm_shuffle_epi32(d, 0x4e));
+		const __m128d b0 = _mm_add_pd(beat0, _mm_mul_pd(d0, bpf));
+		const __m128d b1 = _mm_add_pd(beat0, _mm_mul_pd(d1, bpf));
+		_mm_storeu_pd(beats + i, b0);
+		_mm_storeu_pd(beats + i + 2, b1);
+		if (phases) {
+			_mm_storeu_pd(phases + i, phase(b0));
+			_mm_storeu_pd(phases + i + 2, phase(b1));
+		}
+	}
+#endif
+
+	frames_to_beats_scalar(frames + i, beats + i,
+		phases ? phases + i : nullptr, n - i);
+}
+
+
+// Link beats to JACK transport frames (nearest).
+void jack_link_convert::beats_to_frames ( const double *beats,
+	jack_nframes_t *frames, std::size_t n ) const
+{
+	std::size_t i = 0;
+
+#if defined(__SSE2__)
+	// Tempo ramps: scalar kernels only...
+	const std::size_t m = (m_tempo.ramp ? 0 : n);
+
+	const __m128i frame0 = _mm_set1_epi32(int32_t(m_frame));
+	const __m128d beat0 = _mm_set1_pd(m_beat);
+	const __m128d fpb = _mm_set1_pd(m_frames_per_beat);
+
+	for (; i + 4 <= m; i += 4) {
+		const __m128d b0 = _mm_loadu_pd(beats + i);
+		const __m128d b1 = _mm_loadu_pd(beats + i + 2);
+		const __m128i d0 = _mm_cvtpd_epi32(_mm_mul_pd(_mm_sub_pd(b0, beat0), fpb));
+		const __m128i d1 = _mm_cvtpd_epi32(_mm_mul_pd(_mm_sub_pd(b1, beat0), fpb));
+		_mm_storeu_si128(reinterpret_cast<__m128i *> (frames + i),
+			_mm_add_epi32(_mm_unpacklo_epi64(d0, d1), frame0));
+	}
+#endif
+
+	beats_to_frames_scalar(beats + i, frames + i, n - i);
+}
+
+
+// Scalar kernels.
+void jack_link_convert::frames_to_beats_scalar ( const jack_nframes_t *frames,
+	double *beats, double *phases, std::size_t n ) const
+{
+	for (std::size_t i = 0; i < n; ++i) {
+		double b = m_beat;
+		if (m_tempo.ramp) {
+			// Along the tempo map, relative to the snapshot frame...
+			b += m_tempo.beats(frames[i]) - m_tempo_beat;
+		} else {
+			const int32_t d = int32_t(frames[i] - m_frame);
+			b += double(d) * m_beats_per_frame;
+		}
+		beats[i] = b;
+		if (phases)
+			phases[i] = b - m_quantum * std::floor(b * m_quantum_inv);
+	}
+}
+
+
+void jack_link_convert::beats_to_frames_scalar ( const double *beats,
+	jack_nframes_t *frames, std::size_t n ) const
+{
+	for (std::size_t i = 0; i < n; ++i) {
+		if (m_tempo.ramp) {
+			const double f = m_tempo.frame(beats[i] - m_beat + m_tempo_beat);
+			frames[i] = jack_nframes_t(int64_t(std::llround(f)));
+		} else {
+			const int32_t d = int32_t(std::lrint((beats[i] - m_beat) * m_frames_per_beat));
+			frames[i] = m_frame + jack_nframes_t(d);
+		}
+	}
+}
+
+
+// end of jack_link_convert.cpp
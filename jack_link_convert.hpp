@@ -0,0 +1,79 @@
+// jack_link_convert.hpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#pragma once
+
+#include "jack_link.h"
+
+#include "jack_link_tempo.hpp"
+
+#include <cstddef>
+
+
+//---------------------------------------------------------------------
+// jack_link_convert -- decl.
+//
+// Batch JACK transport frame to/from Link beat conversions, all against
+// the one state snapshot: the frame-beat tempo map is anchored on the
+// snapshot transport frame and Link beat (ie. at the start of the last
+// cycle). SSE2 kernels for constant tempo where available, scalar ones
+// otherwise (tempo ramps, and the tails).
+//
+
+class jack_link_convert
+{
+public:
+
+	// Constructor.
+	jack_link_convert(const jack_link_state_t& state,
+		const jack_link_tempo& tempo);
+
+	bool valid() const { return (m_beats_per_frame > 0.0); }
+
+	// JACK transport frames to Link beats and phases (optional).
+	void frames_to_beats(const jack_nframes_t *frames,
+		double *beats, double *phases, std::size_t n) const;
+
+	// Link beats to JACK transport frames (nearest).
+	void beats_to_frames(const double *beats,
+		jack_nframes_t *frames, std::size_t n) const;
+
+	// Scalar kernels.
+	void frames_to_beats_scalar(const jack_nframes_t *frames,
+		double *beats, double *phases, std::size_t n) const;
+	void beats_to_frames_scalar(const double *beats,
+		jack_nframes_t *frames, std::size_t n) const;
+
+private:
+
+	jack_link_tempo m_tempo;
+	double m_tempo_beat;
+
+	jack_nframes_t m_frame;
+	double m_beat;
+	double m_quantum;
+	double m_quantum_inv;
+	double m_beats_per_frame;
+	double m_frames_per_beat;
+};
+
+
+// end of jack_link_convert.hpp
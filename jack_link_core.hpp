@@ -0,0 +1,982 @@
+// jack_link_core.hpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+
+#include <cstdint>
+
+#include "jack_link_tempo.hpp"
+
+
+//---------------------------------------------------------------------
+// jack_link_core -- decl.
+//
+// The real-time bridge core, over compile-time policies:
+//
+//   Transport - JACK transport backend (eg. jack_link_jack);
+//   Link      - Link session and clock (eg. ableton::Link).
+//
+// Either may be replaced by in-memory fakes (simulation, benchmarks),
+// with no libjack nor network involved: all JACK types and position
+// bits come from the Transport policy (eg. jack_link_stub.cpp).
+//
+
+template <typename Transport, typename Link>
+class jack_link_core
+{
+public:
+
+	typedef typename Transport::client_type client_type;
+	typedef typename Transport::nframes_type nframes_type;
+	typedef typename Transport::state_type state_type;
+	typedef typename Transport::position_type position_type;
+
+	jack_link_core(client_type *client);
+
+	// Real-time entry points.
+	void timebase_process(
+		state_type state,
+		nframes_type nframes,
+		position_type *pos,
+		int new_pos);
+
+	int sync_process(
+		state_type state,
+		position_type *pos);
+
+	void transport_process(
+		state_type state,
+		nframes_type nframes,
+		const position_type *pos);
+
+	void observer_process(nframes_type nframes);
+
+	void schedule_process(
+		state_type state,
+		nframes_type nframes,
+		const position_type *pos);
+
+	// Freewheel (offline render) on/off.
+	void freewheel_process(int starting);
+
+	// Engine events (applied on next cycle, real-time safe).
+	void xrun_process();
+	void buffer_size_process(nframes_type nframes);
+	void srate_process(nframes_type srate);
+
+	// Tempo ramps: length (beats, zero for none), curve and
+	// Link update rate (Hz); setup before activation.
+	enum {
+		RampLinear = jack_link_tempo::RampLinear,
+		RampExponential = jack_link_tempo::RampExponential
+	};
+
+	void ramp_setup(double beats, int curve, double rate);
+
+	// Position helpers.
+	void timebase_position(position_type *pos) const;
+
+	double position_beat(const position_type *pos) const;
+
+	// Tempo map snapshot (process thread).
+	void tempo_map(jack_link_tempo& map) const;
+
+protected:
+
+	// Scheduled JACK transport requests (Link quantum aligned).
+	enum { TransportNone = 0, TransportStart, TransportStop };
+
+	// Beat-scheduled commands (Link beat, time-ordered).
+	enum { ScheduleTempo = 0, ScheduleStart, ScheduleStop, ScheduleQuantum };
+
+	struct schedule_item
+	{
+		double beat;
+		int command;
+		double value;
+	};
+
+	// Post a command (single non-real-time producer, lock-free).
+	bool schedule_post(double beat, int command, double value);
+
+	void tempo_update();
+
+	// Whether some tempo is an echo of our own latest commits.
+	bool tempo_echo(double tempo) const;
+
+	// Tempo map: anchor reset, anchor at some frame (ramps cut
+	// short, straight to target tempo) and ramp evaluation.
+	void tempo_reset();
+	void tempo_anchor(nframes_type frame);
+	void ramp_update(nframes_type frame, bool rolling);
+
+	// Tempo ramp beats and tempo, at some frame (closed-form).
+	double ramp_beats(nframes_type frame,
+		double frame_rate, double& beats_per_minute) const;
+
+	// Per-cycle conversion constants (setup and pending updates).
+	void config_setup(nframes_type srate, nframes_type buffer_size);
+	bool config_update();
+
+	std::chrono::microseconds period(nframes_type nframes) const;
+
+	// Host time at the current cycle start (process thread only).
+	std::chrono::microseconds cycle_time() const;
+
+	void timebase_relocate(nframes_type nframes, position_type *pos);
+
+	// Tempo map re-anchored to the Link timeline (bounded steps,
+	// or all at once when back from freewheel).
+	void timebase_resync(nframes_type nframes, const position_type *pos);
+
+	// Wrap beat difference into half a bar either way.
+	static double divergence(double beats, double beats_per_bar);
+
+	// Running statistics update (single writer).
+	static void divergence_update(double d,
+		std::atomic<double>& last,
+		std::atomic<double>& max,
+		std::atomic<double>& sum);
+
+	Link m_link;
+	client_type *m_client;
+	double m_srate;
+	nframes_type m_buffer_size;
+	std::chrono::microseconds m_period;
+	std::atomic<nframes_type> m_srate_req;
+	std::atomic<nframes_type> m_buffer_size_req;
+	std::atomic<unsigned long> m_timebase;
+	nframes_type m_timebase_next;
+	std::atomic<unsigned long> m_relocations;
+	std::atomic<unsigned long> m_observed;
+	std::atomic<unsigned long> m_jack_observed;
+	std::atomic<double> m_jack_divergence;
+	std::atomic<double> m_jack_divergence_max;
+	std::atomic<double> m_jack_divergence_sum;
+	std::atomic<double> m_link_divergence;
+	std::atomic<double> m_link_divergence_max;
+	std::atomic<double> m_link_divergence_sum;
+	double m_tempo;
+	std::atomic<double> m_tempo_req;
+	std::atomic<double> m_quantum;
+	std::atomic<bool> m_playing;
+	std::atomic<bool> m_playing_req;
+	std::atomic<int> m_transport_req;
+	std::atomic<bool> m_freewheel;
+	std::atomic<unsigned int> m_resync;
+	std::atomic<unsigned long> m_resyncs;
+	std::atomic<bool> m_rejoin;
+
+	// Tempo map anchor: beats at some frame, on a constant tempo.
+	nframes_type m_anchor_frame;
+	double m_anchor_beats;
+
+	// Tempo ramp setup, requests and current state.
+	double m_ramp_length;
+	int m_ramp_curve;
+	std::chrono::microseconds m_ramp_period;
+	std::atomic<double> m_ramp_req;
+	bool m_ramp;
+	nframes_type m_ramp_frame;
+	nframes_type m_ramp_frames;
+	double m_ramp_beats;
+	double m_ramp_tempo0;
+	double m_ramp_tempo1;
+	std::chrono::microseconds m_ramp_commit;
+	double m_ramp_hold;
+
+	// Own tempo commits to Link (ramps), most recent ones.
+	static const std::size_t c_echo_size = 16;
+
+	double m_echo[c_echo_size];
+	std::size_t m_echo_next;
+
+	// Posted commands ring and pending queue, sorted by
+	// descending beat: the head (next due) is the last one.
+	static const std::size_t c_schedule_size = 64;
+
+	// Resync correction bound, per cycle (fraction of its beats).
+	static constexpr double c_resync_rate = 0.25;
+
+	schedule_item m_schedule_ring[c_schedule_size];
+	std::atomic<std::size_t> m_schedule_read;
+	std::atomic<std::size_t> m_schedule_write;
+	schedule_item m_schedule[c_schedule_size];
+	std::size_t m_nschedule;
+
+	// Scheduled tempo change due, for the timebase callback.
+	double m_schedule_tempo;
+	nframes_type m_schedule_frame;
+};
+
+
+//---------------------------------------------------------------------
+// jack_link_core -- impl.
+//
+
+template <typename Transport, typename Link>
+jack_link_core<Transport, Link>::jack_link_core ( client_type *client ) :
+	m_link(120.0), m_client(client), m_srate(44100.0),
+	m_buffer_size(1024), m_period(0), m_srate_req(0), m_buffer_size_req(0),
+	m_timebase(0), m_timebase_next(0), m_relocations(0),
+	m_observed(0), m_jack_observed(0),
+	m_jack_divergence(0.0), m_jack_divergence_max(0.0), m_jack_divergence_sum(0.0),
+	m_link_divergence(0.0), m_link_divergence_max(0.0), m_link_divergence_sum(0.0),
+	m_tempo(120.0), m_tempo_req(0.0), m_quantum(4.0),
+	m_playing(false), m_playing_req(false), m_transport_req(TransportNone),
+	m_freewheel(false), m_resync(0), m_resyncs(0), m_rejoin(false),
+	m_anchor_frame(0), m_anchor_beats(0.0),
+	m_ramp_length(0.0), m_ramp_curve(RampLinear), m_ramp_period(100000),
+	m_ramp_req(0.0), m_ramp(false), m_ramp_frame(0), m_ramp_frames(0),
+	m_ramp_beats(0.0), m_ramp_tempo0(0.0), m_ramp_tempo1(0.0),
+	m_ramp_commit(0), m_ramp_hold(0.0), m_echo_next(0),
+	m_schedule_read(0), m_schedule_write(0), m_nschedule(0),
+	m_schedule_tempo(0.0), m_schedule_frame(0)
+{
+	std::fill(m_echo, m_echo + c_echo_size, 0.0);
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::timebase_process (
+	state_type state, nframes_type nframes,
+	position_type *pos, int new_pos )
+{
+	// Relocated? (new position or frame discontinuity while rolling)
+	const bool rolling = Transport::rolling(state);
+	const bool relocated
+		= (new_pos || (rolling && pos->frame != m_timebase_next));
+
+	// Any relocation resets the tempo map (ramps end right away)...
+	if (relocated)
+		tempo_reset();
+
+	// Scheduled tempo change, due since this cycle (in place)...
+	if (m_schedule_tempo > 0.0) {
+		if (!relocated)
+			tempo_anchor(m_schedule_frame);
+		m_tempo = m_schedule_tempo;
+		m_schedule_tempo = 0.0;
+	}
+
+	// Frozen tempo map, decoupled from Link while freewheeling...
+	if (!m_freewheel) {
+		tempo_update();
+		ramp_update(pos->frame, rolling);
+	}
+
+	// Engine hiccup (eg. xrun) or back from freewheel: the tempo map
+	// gets pulled back onto the Link timeline, never the other way...
+	if (!m_freewheel && rolling && !relocated && (m_resync > 0 || m_rejoin))
+		timebase_resync(nframes, pos);
+
+	timebase_position(pos);
+
+	// Relocated while rolling?
+	if (!m_freewheel && rolling && relocated)
+		timebase_relocate(nframes, pos);
+
+	m_timebase_next = pos->frame + (rolling ? nframes : 0);
+
+	++m_timebase;
+}
+
+
+template <typename Transport, typename Link>
+inline int jack_link_core<Transport, Link>::sync_process (
+	state_type state, position_type *pos )
+{
+	if (m_freewheel)
+		return 1;
+
+	if (Transport::starting(state) && m_playing && !m_playing_req) {
+		// Sync to current JACK transport frame-beat quantum...
+		auto session_state = m_link.captureAudioSessionState();
+		const auto host_time = m_link.clock().micros();
+		const double beat = position_beat(pos);
+		session_state.forceBeatAtTime(beat, host_time, m_quantum);
+		m_link.commitAudioSessionState(session_state);
+	}
+
+	return 1;
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::transport_process (
+	state_type state, nframes_type nframes, const position_type *pos )
+{
+	// Already there? (eg. late Link echoes)
+	const bool playing
+		= (Transport::rolling(state) || Transport::starting(state));
+	if (playing == (m_transport_req == TransportStart)) {
+		m_transport_req = TransportNone;
+		return;
+	}
+
+	const auto session_state = m_link.captureAudioSessionState();
+	const auto cycle_time = jack_link_core::cycle_time();
+	const auto period = jack_link_core::period(nframes);
+	const auto playing_time = session_state.timeForIsPlaying();
+
+	if (m_transport_req == TransportStart) {
+		// Starts get rolled two cycles later (Starting, then Rolling,
+		// past the sync callbacks) and heard one period after that
+		// (output latency)...
+		const auto roll_time = cycle_time + m_period + 2 * period;
+		// First quantum boundary (phase zero) at or after the
+		// Link start/stop sync time, within the rolling cycle...
+		const double quantum = std::max(m_quantum.load(), 1.0);
+		const auto start_time = std::max(roll_time, playing_time);
+		const double beat = session_state.beatAtTime(start_time, quantum);
+		const double beat_zero = quantum * std::ceil(beat / quantum);
+		const auto beat_time = session_state.timeAtBeat(beat_zero, quantum);
+		if (beat_time >= roll_time + period)
+			return;
+		// Rewind JACK transport before the current bar start, so
+		// that the bar start gets rolled exactly on that boundary;
+		// as mapped once located, ie. from the zero anchor on, any
+		// ramp done at target tempo (see tempo_reset)...
+		const double beats_per_minute = (m_ramp ? m_ramp_tempo1 : m_tempo);
+		const double bar_frames
+			= 60.0 * pos->frame_rate * quantum / beats_per_minute;
+		const int64_t offset = std::llround(
+			1.0e-6 * (beat_time - roll_time).count() * pos->frame_rate);
+		double bar = std::floor(double(pos->frame) / bar_frames);
+		int64_t frame = std::llround(bar * bar_frames) - offset;
+		while (frame < 0)
+			frame = std::llround(++bar * bar_frames) - offset;
+		Transport::locate(m_client, nframes_type(frame));
+		Transport::start(m_client);
+	} else {
+		// Stops take effect on the next cycle, heard one period
+		// after that; issued on the nearest one...
+		const auto stop_time = cycle_time + m_period + period;
+		if (playing_time >= stop_time + period / 2)
+			return;
+		Transport::stop(m_client);
+	}
+
+	m_transport_req = TransportNone;
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::observer_process (
+	nframes_type /*nframes*/ )
+{
+	tempo_update();
+
+	position_type pos;
+	const state_type state
+		= Transport::query(m_client, &pos);
+
+	if (!Transport::rolling(state))
+		return;
+
+	// What would have been published, as timebase master...
+	position_type shadow = pos;
+	timebase_position(&shadow);
+
+	const double beats_per_bar = std::max(m_quantum.load(), 1.0);
+	const double beat = position_beat(&shadow) + beats_per_bar;
+
+	// Against the actual JACK transport, when published...
+	if (Transport::bbt(&pos)) {
+		const double jack_beat = position_beat(&pos) + pos.beats_per_bar;
+		divergence_update(
+			divergence(beat - jack_beat, beats_per_bar),
+			m_jack_divergence, m_jack_divergence_max, m_jack_divergence_sum);
+		++m_jack_observed;
+	}
+
+	// Against the Link timeline, as the cycle gets heard...
+	const auto session_state = m_link.captureAudioSessionState();
+	const auto host_time = cycle_time() + m_period;
+	const double phase = session_state.phaseAtTime(host_time, beats_per_bar);
+	divergence_update(
+		divergence(beat - phase, beats_per_bar),
+		m_link_divergence, m_link_divergence_max, m_link_divergence_sum);
+
+	++m_observed;
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::schedule_process (
+	state_type state, nframes_type nframes, const position_type *pos )
+{
+	// Take newly posted commands in, while there's room...
+	std::size_t r = m_schedule_read.load(std::memory_order_relaxed);
+	const std::size_t w = m_schedule_write.load(std::memory_order_acquire);
+	for (; r != w && m_nschedule < c_schedule_size; ++r) {
+		const schedule_item& item = m_schedule_ring[r % c_schedule_size];
+		std::size_t i = m_nschedule++;
+		for (; i > 0 && m_schedule[i - 1].beat <= item.beat; --i)
+			m_schedule[i] = m_schedule[i - 1];
+		m_schedule[i] = item;
+	}
+	m_schedule_read.store(r, std::memory_order_release);
+
+	if (m_nschedule == 0)
+		return;
+
+	// Apply whatever gets heard within this cycle, at the exact beat
+	// time (or right away, when already past); JACK transport starts
+	// and stops get taken in ahead of their latency, to be issued on
+	// the right cycle (see transport_process)...
+	auto session_state = m_link.captureAudioSessionState();
+	const auto period = jack_link_core::period(nframes);
+	const auto heard_time = cycle_time() + m_period;
+	const auto next_time = heard_time + period;
+	const bool rolling = Transport::rolling(state);
+	bool commit = false;
+
+	while (m_nschedule > 0) {
+		const schedule_item& item = m_schedule[m_nschedule - 1];
+		const double quantum = std::max(m_quantum.load(), 1.0);
+		const auto beat_time = std::max(heard_time,
+			session_state.timeAtBeat(item.beat, quantum));
+		auto due_time = next_time;
+		if (item.command == ScheduleStart)
+			due_time += 2 * period;
+		else
+		if (item.command == ScheduleStop)
+			due_time += period;
+		if (beat_time >= due_time)
+			break;
+		switch (item.command) {
+		case ScheduleTempo:
+			session_state.setTempo(item.value, beat_time);
+			// Timebase tempo map follows right on that frame...
+			m_schedule_tempo = item.value;
+			m_schedule_frame = pos->frame;
+			if (rolling) {
+				m_schedule_frame += nframes_type(std::llround(
+					1.0e-6 * (beat_time - heard_time).count() * m_srate));
+			}
+			commit = true;
+			break;
+		case ScheduleStart:
+		case ScheduleStop:
+			// JACK transport follows from this very cycle, with
+			// the Link start/stop echo taken as ours...
+			m_playing_req = true;
+			m_playing = (item.command == ScheduleStart);
+			m_transport_req = (m_playing ? TransportStart : TransportStop);
+			session_state.setIsPlaying(m_playing, beat_time);
+			commit = true;
+			break;
+		case ScheduleQuantum:
+			m_quantum = item.value;
+			break;
+		}
+		--m_nschedule;
+	}
+
+	if (commit)
+		m_link.commitAudioSessionState(session_state);
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::freewheel_process (
+	int starting )
+{
+	// Leaving: rejoin the Link timeline once rolling...
+	if (!starting)
+		m_rejoin = true;
+
+	m_freewheel = (starting != 0);
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::xrun_process (void)
+{
+	// Cycles lost: re-anchor to the Link timeline once rolling...
+	++m_resync;
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::buffer_size_process (
+	nframes_type nframes )
+{
+	m_buffer_size_req = nframes;
+	++m_resync;
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::srate_process (
+	nframes_type srate )
+{
+	m_srate_req = srate;
+	++m_resync;
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::ramp_setup (
+	double beats, int curve, double rate )
+{
+	m_ramp_length = std::max(beats, 0.0);
+	m_ramp_curve = curve;
+	if (rate > 0.0)
+		m_ramp_period = std::chrono::microseconds(std::llround(1.0e6 / rate));
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::timebase_position (
+	position_type *pos ) const
+{
+	double beats_per_minute = m_tempo;
+	const double beats_per_bar = std::max(m_quantum.load(), 1.0);
+
+	const bool   valid = Transport::bbt(pos);
+	const double ticks_per_beat = (valid ? pos->ticks_per_beat : 960.0);
+	const float  beat_type = (valid ? pos->beat_type : 4.0f);
+
+	// Exact (fractional) ticks at the current cycle frame...
+	double ticks_exact;
+	if (m_ramp) {
+		// Ramping: integrated beats, local tempo...
+		ticks_exact = ticks_per_beat * ramp_beats(
+			pos->frame, double(pos->frame_rate), beats_per_minute);
+	} else {
+		// Constant tempo, from the anchor on...
+		const double frames
+			= jack_link_tempo::frame_delta(pos->frame, m_anchor_frame);
+		ticks_exact = ticks_per_beat * (m_anchor_beats
+			+ frames * beats_per_minute / (60.0 * double(pos->frame_rate)));
+	}
+
+	// Snap BBT onto the last tick boundary at or before the
+	// current cycle frame, giving the frame offset to it...
+	const double frames_per_tick
+		= 60.0 * double(pos->frame_rate)
+		/ (beats_per_minute * ticks_per_beat);
+	const double ticks = std::floor(ticks_exact);
+	const double frame = std::min(std::ceil(double(pos->frame)
+		- (ticks_exact - ticks) * frames_per_tick), double(pos->frame));
+	const nframes_type offset = pos->frame - nframes_type(frame);
+
+	const double beats = std::floor(ticks / ticks_per_beat);
+	const double bar = std::floor(beats / beats_per_bar);
+	const double beat = beats - bar * beats_per_bar;
+	const double tick = ticks - beats * ticks_per_beat;
+
+	Transport::set_bbt(pos);
+	pos->bar = int32_t(bar) + 1;
+	pos->beat = int32_t(beat) + 1;
+	pos->tick = int32_t(tick);
+	pos->beats_per_bar = float(beats_per_bar);
+	pos->ticks_per_beat = ticks_per_beat;
+	pos->beats_per_minute = beats_per_minute;
+	pos->beat_type = beat_type;
+	pos->bar_start_tick = bar * beats_per_bar * ticks_per_beat;
+	pos->bbt_offset = offset;
+	// Double resolution tick, unsnapped (ie. at the cycle frame)...
+	Transport::set_tick_double(pos, tick + (ticks_exact - ticks));
+}
+
+
+template <typename Transport, typename Link>
+inline double jack_link_core<Transport, Link>::position_beat (
+	const position_type *pos ) const
+{
+	if (Transport::bbt(pos)) {
+		double tick = double(pos->tick);
+		const bool tick_exact = Transport::tick_double(pos, tick);
+		double beats
+			= double(pos->beat - 1)
+			+ tick / double(pos->ticks_per_beat);
+		// BBT may refer to some frames before the current one,
+		// unless given with the exact tick at the current one...
+		if (Transport::bbt_offset(pos) && !tick_exact) {
+			beats += pos->beats_per_minute * pos->bbt_offset
+				/ (60.0 * pos->frame_rate);
+		}
+		return beats - double(pos->beats_per_bar);
+	} else {
+		const double quantum
+			= std::max(m_quantum.load(), 1.0);
+		const double beats
+			= m_tempo * pos->frame / (60.0 * pos->frame_rate);
+		return std::fmod(beats, quantum) - quantum;
+	}
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::tempo_update (void)
+{
+	// Pick up the latest tempo request only (coalesced)...
+	double tempo_req = m_tempo_req;
+	if (tempo_req <= 0.0)
+		return;
+
+	// Ramping, or just done: own Link commits get echoed back
+	// (dropped), anything else is kept pending until a while
+	// after the final one...
+	if (!m_ramp && m_ramp_hold > 0.0) {
+		const auto host_time = m_link.clock().micros();
+		if (host_time >= m_ramp_commit + std::chrono::seconds(1))
+			m_ramp_hold = 0.0;
+	}
+	if (m_ramp || m_ramp_hold > 0.0) {
+		if (tempo_echo(tempo_req))
+			m_tempo_req.compare_exchange_strong(tempo_req, 0.0);
+		return;
+	}
+
+	// Unless superseded meanwhile (next cycle)...
+	if (m_tempo_req.compare_exchange_strong(tempo_req, 0.0))
+		m_tempo = tempo_req;
+}
+
+
+template <typename Transport, typename Link>
+inline bool jack_link_core<Transport, Link>::tempo_echo ( double tempo ) const
+{
+	// Link keeps whole microseconds per beat: tempo echoes
+	// may be off by as much as a microsecond worth...
+	const double tolerance = tempo * tempo / 60.0e6;
+	for (std::size_t i = 0; i < c_echo_size; ++i) {
+		if (std::abs(tempo - m_echo[i]) <= tolerance)
+			return true;
+	}
+
+	return false;
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::tempo_reset (void)
+{
+	// Ramp cut short, straight to target tempo...
+	if (m_ramp) {
+		m_ramp = false;
+		m_tempo = m_ramp_tempo1;
+	}
+
+	// Back to the plain frame-beat mapping (zero anchor)...
+	m_anchor_frame = 0;
+	m_anchor_beats = 0.0;
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::tempo_anchor (
+	nframes_type frame )
+{
+	// Carry on from the current position, where a ramp
+	// cut short goes straight to target tempo from...
+	if (m_ramp) {
+		double beats_per_minute = m_tempo;
+		m_anchor_beats = ramp_beats(frame, m_srate, beats_per_minute);
+		m_ramp = false;
+		m_tempo = m_ramp_tempo1;
+	} else {
+		const double frames
+			= jack_link_tempo::frame_delta(frame, m_anchor_frame);
+		m_anchor_beats += frames * m_tempo / (60.0 * m_srate);
+	}
+
+	m_anchor_frame = frame;
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::ramp_update (
+	nframes_type frame, bool rolling )
+{
+	const auto host_time = m_link.clock().micros();
+
+	bool commit = false;
+
+	// New ramp request? (from the current tempo and position)
+	const double tempo = m_ramp_req.exchange(0.0);
+	if (tempo > 0.0 && tempo != m_tempo) {
+		double beats_per_minute = m_tempo;
+		const double beats = (m_ramp
+			? ramp_beats(frame, m_srate, beats_per_minute)
+			: m_anchor_beats + m_tempo / (60.0 * m_srate)
+				* jack_link_tempo::frame_delta(frame, m_anchor_frame));
+		const double t0 = beats_per_minute;
+		const double t1 = tempo;
+		const double length = m_ramp_length;
+		// Ramp duration (seconds), closed-form...
+		const double secs = (length > 0.0
+			? jack_link_tempo::ramp_curve_secs(m_ramp_curve, t0, t1, length, length)
+			: 0.0);
+		m_ramp = (rolling && length > 0.0);
+		m_ramp_frame = frame;
+		m_ramp_frames = nframes_type(std::llround(secs * m_srate));
+		m_ramp_beats = beats;
+		m_ramp_tempo0 = t0;
+		m_ramp_tempo1 = t1;
+		m_ramp_hold = t1;
+		m_ramp_commit = host_time - m_ramp_period;
+		m_tempo = t0;
+		// Not rolling: straight to target tempo...
+		if (!m_ramp) {
+			m_anchor_frame = frame;
+			m_anchor_beats = beats;
+			m_tempo = t1;
+			commit = true;
+		}
+	}
+
+	// Ramp evaluation at the current cycle frame...
+	if (m_ramp) {
+		const nframes_type frames = frame - m_ramp_frame;
+		if (frames >= m_ramp_frames) {
+			// Done: carry on from the ramp end point...
+			m_ramp = false;
+			m_anchor_frame = m_ramp_frame + m_ramp_frames;
+			m_anchor_beats = m_ramp_beats + m_ramp_length;
+			m_tempo = m_ramp_tempo1;
+			commit = true;
+		}
+		else
+		if (!rolling) {
+			// Stopped midway: from right here, at target tempo...
+			tempo_anchor(frame);
+			commit = true;
+		} else {
+			ramp_beats(frame, m_srate, m_tempo);
+			commit = (host_time >= m_ramp_commit + m_ramp_period);
+		}
+	}
+
+	// Committed to Link at a bounded rate, and once done...
+	if (commit) {
+		auto session_state = m_link.captureAudioSessionState();
+		session_state.setTempo(m_tempo, host_time);
+		m_link.commitAudioSessionState(session_state);
+		m_ramp_commit = host_time;
+		m_echo[m_echo_next] = m_tempo;
+		m_echo_next = (m_echo_next + 1) % c_echo_size;
+	}
+}
+
+
+template <typename Transport, typename Link>
+inline double jack_link_core<Transport, Link>::ramp_beats (
+	nframes_type frame, double frame_rate, double& beats_per_minute ) const
+{
+	const double t0 = m_ramp_tempo0;
+	const double t1 = m_ramp_tempo1;
+	const double length = m_ramp_length;
+	const double t
+		= jack_link_tempo::frame_delta(frame, m_ramp_frame) / frame_rate;
+
+	// Past the ramp end, at target tempo (eg. frozen while
+	// freewheeling, never evaluated nor ended in between)...
+	const double t_end = double(m_ramp_frames) / frame_rate;
+	if (t >= t_end) {
+		beats_per_minute = t1;
+		return m_ramp_beats + length + (t - t_end) * t1 / 60.0;
+	}
+
+	const double beats = jack_link_tempo::ramp_curve_beats(
+		m_ramp_curve, t0, t1, length, t, beats_per_minute);
+
+	return m_ramp_beats + std::min(beats, length);
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::tempo_map (
+	jack_link_tempo& map ) const
+{
+	map.anchor_frame = m_anchor_frame;
+	map.anchor_beats = m_anchor_beats;
+	map.tempo = m_tempo;
+	map.ramp = (m_ramp ? 1 : 0);
+	map.ramp_curve = m_ramp_curve;
+	map.ramp_frame = m_ramp_frame;
+	map.ramp_frames = m_ramp_frames;
+	map.ramp_beats = m_ramp_beats;
+	map.ramp_tempo0 = m_ramp_tempo0;
+	map.ramp_tempo1 = m_ramp_tempo1;
+	map.ramp_length = m_ramp_length;
+	map.srate = m_srate;
+}
+
+
+template <typename Transport, typename Link>
+inline bool jack_link_core<Transport, Link>::schedule_post (
+	double beat, int command, double value )
+{
+	const std::size_t w = m_schedule_write.load(std::memory_order_relaxed);
+	if (w - m_schedule_read.load(std::memory_order_acquire) >= c_schedule_size)
+		return false;
+
+	schedule_item& item = m_schedule_ring[w % c_schedule_size];
+	item.beat = beat;
+	item.command = command;
+	item.value = value;
+
+	m_schedule_write.store(w + 1, std::memory_order_release);
+	return true;
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::config_setup (
+	nframes_type srate, nframes_type buffer_size )
+{
+	if (srate > 0)
+		m_srate = double(srate);
+	if (buffer_size > 0)
+		m_buffer_size = buffer_size;
+
+	m_period = std::chrono::microseconds(
+		std::llround(1.0e6 * m_buffer_size / m_srate));
+}
+
+
+template <typename Transport, typename Link>
+inline bool jack_link_core<Transport, Link>::config_update (void)
+{
+	const nframes_type srate = m_srate_req.exchange(0);
+	const nframes_type buffer_size = m_buffer_size_req.exchange(0);
+	if (srate == 0 && buffer_size == 0)
+		return false;
+
+	config_setup(srate, buffer_size);
+	return true;
+}
+
+
+template <typename Transport, typename Link>
+inline std::chrono::microseconds jack_link_core<Transport, Link>::period (
+	nframes_type nframes ) const
+{
+	if (nframes == m_buffer_size)
+		return m_period;
+
+	return std::chrono::microseconds(
+		std::llround(1.0e6 * nframes / m_srate));
+}
+
+
+template <typename Transport, typename Link>
+inline std::chrono::microseconds jack_link_core<Transport, Link>::cycle_time (void) const
+{
+	const nframes_type frames
+		= Transport::frames_since_cycle_start(m_client);
+
+	return m_link.clock().micros() - std::chrono::microseconds(
+		std::llround(1.0e6 * frames / m_srate));
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::timebase_relocate (
+	nframes_type nframes, position_type *pos )
+{
+	if (!m_playing)
+		return;
+
+	// Sync to the new JACK transport frame-beat quantum, right away,
+	// as the position given (next cycle) gets heard...
+	auto session_state = m_link.captureAudioSessionState();
+	const auto beat_time = cycle_time() + period(nframes) + m_period;
+	const double beat = position_beat(pos);
+	session_state.forceBeatAtTime(beat, beat_time, m_quantum);
+	m_link.commitAudioSessionState(session_state);
+
+	++m_relocations;
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::timebase_resync (
+	nframes_type nframes, const position_type *pos )
+{
+	unsigned int resync = m_resync;
+	const bool rejoin = m_rejoin.exchange(false);
+
+	// Tempo map beat at the position given (next cycle)...
+	double beats_per_minute = m_tempo;
+	double beats = 0.0;
+	if (m_ramp) {
+		beats = ramp_beats(pos->frame, m_srate, beats_per_minute);
+	} else {
+		tempo_anchor(pos->frame);
+		beats = m_anchor_beats;
+	}
+
+	// ...against the Link beat, as it gets heard...
+	const double quantum = std::max(m_quantum.load(), 1.0);
+	const auto session_state = m_link.captureAudioSessionState();
+	const auto beat_time = cycle_time() + period(nframes) + m_period;
+	const double beat = session_state.beatAtTime(beat_time, quantum);
+	double d = divergence(beat - beats, quantum);
+
+	// Bounded correction, over as many cycles as it takes;
+	// done when within bounds, unless requested again, or
+	// else all at once, as nothing was heard in realtime...
+	const double step = c_resync_rate
+		* beats_per_minute * nframes / (60.0 * m_srate);
+	if (!rejoin && std::abs(d) > step)
+		d = std::copysign(step, d);
+	else
+	if (resync > 0 && m_resync.compare_exchange_strong(resync, 0))
+		++m_resyncs;
+
+	if (m_ramp)
+		m_ramp_beats += d;
+	else
+		m_anchor_beats += d;
+}
+
+
+template <typename Transport, typename Link>
+inline double jack_link_core<Transport, Link>::divergence (
+	double beats, double beats_per_bar )
+{
+	return beats - beats_per_bar * std::floor(beats / beats_per_bar + 0.5);
+}
+
+
+template <typename Transport, typename Link>
+inline void jack_link_core<Transport, Link>::divergence_update ( double d,
+	std::atomic<double>& last, std::atomic<double>& max, std::atomic<double>& sum )
+{
+	last = d;
+	if (std::abs(d) > max)
+		max = std::abs(d);
+	sum = sum + std::abs(d);
+}
+
+
+// end of jack_link_core.hpp
@@ -0,0 +1,107 @@
+// jack_link_internal.cpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "jack_link.hpp"
+
+#include "jack_link_log.hpp"
+
+#include <string>
+
+#include <cstdlib>
+
+
+// internal client stuff...
+//
+// To load into the running JACK server:
+//
+//   jack_load jack_link jack_link.so -i "[options]"
+//
+// and then control it at runtime through its named pipe:
+//
+//   echo "tempo 128" > ${XDG_RUNTIME_DIR:-/tmp}/jack_link.ctl
+//
+
+static jack_link_log *g_logger = nullptr;
+static unsigned int g_clients = 0;
+
+
+extern "C" {
+
+int  jack_initialize ( jack_client_t *client, const char *load_init );
+void jack_finish ( void *arg );
+
+}
+
+
+int jack_initialize ( jack_client_t *client, const char *load_init )
+{
+	const std::string name = ::jack_get_client_name(client);
+
+	// Load init string, if any (jackd may well pass none)...
+	const char *args = (load_init ? load_init : "");
+
+	// No console here, always log to file...
+	if (g_logger == nullptr) {
+		g_logger = new jack_link_log();
+		g_logger->start(JACK_LINK_NAME, name);
+	}
+
+	++g_clients;
+
+	jack_link_log("Internal client is starting (%s)...", args);
+	jack_link_log(JACK_LINK_NAME " v" JACK_LINK_VERSION " (Link v" ABLETON_LINK_VERSION ")");
+
+	// Load init string as command line options...
+	jack_link_options options;
+	options.parse(args);
+
+	// Keep running as long as the server does...
+	options.supervised = false;
+
+	// No console either, always have a control pipe...
+	if (options.control.empty()) {
+		const char *dir = ::getenv("XDG_RUNTIME_DIR");
+		options.control = std::string(dir ? dir : "/tmp") + '/' + name + ".ctl";
+	}
+
+	new jack_link(client, options);
+
+	return 0;
+}
+
+
+void jack_finish ( void *arg )
+{
+	jack_link *app = static_cast<jack_link *> (arg);
+	if (app)
+		delete app;
+
+	jack_link_log("Internal client terminated.");
+
+	if (--g_clients == 0 && g_logger) {
+		g_logger->stop();
+		delete g_logger;
+		g_logger = nullptr;
+	}
+}
+
+
+// end of jack_link_internal.cpp
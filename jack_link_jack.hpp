@@ -0,0 +1,102 @@
+// jack_link_jack.hpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#pragma once
+
+#include <jack/jack.h>
+#include <jack/transport.h>
+
+
+//---------------------------------------------------------------------
+// jack_link_jack -- JACK transport backend policy (libjack).
+//
+// Everything JACK specific the bridge core gets to see: client, frame,
+// transport state and position types, position validity bits and the
+// transport calls proper, all inline.
+//
+
+struct jack_link_jack
+{
+	typedef jack_client_t client_type;
+	typedef jack_nframes_t nframes_type;
+	typedef jack_transport_state_t state_type;
+	typedef jack_position_t position_type;
+
+	// Transport states.
+	static bool rolling ( state_type state )
+		{ return (state == JackTransportRolling || state == JackTransportLooping); }
+
+	static bool starting ( state_type state )
+		{ return (state == JackTransportStarting); }
+
+	// Position validity (BBT, BBT frame offset).
+	static bool bbt ( const position_type *pos )
+		{ return (pos->valid & JackPositionBBT); }
+
+	static bool bbt_offset ( const position_type *pos )
+		{ return (pos->valid & JackBBTFrameOffset); }
+
+	static void set_bbt ( position_type *pos )
+		{ pos->valid = jack_position_bits_t(JackPositionBBT | JackBBTFrameOffset); }
+
+	// Double resolution tick, where supported.
+	static bool tick_double ( const position_type *pos, double& tick )
+	{
+	#ifdef JACK_TICK_DOUBLE
+		if (pos->valid & JackTickDouble) {
+			tick = pos->tick_double;
+			return true;
+		}
+	#endif
+		return false;
+	}
+
+	static void set_tick_double ( position_type *pos, double tick )
+	{
+	#ifdef JACK_TICK_DOUBLE
+		pos->valid = jack_position_bits_t(pos->valid | JackTickDouble);
+		pos->tick_double = tick;
+	#else
+		(void) pos; (void) tick;
+	#endif
+	}
+
+	// Transport control.
+	static state_type query (
+		const client_type *client, position_type *pos )
+		{ return ::jack_transport_query(client, pos); }
+
+	static void start ( client_type *client )
+		{ ::jack_transport_start(client); }
+
+	static void stop ( client_type *client )
+		{ ::jack_transport_stop(client); }
+
+	static void locate ( client_type *client, nframes_type frame )
+		{ ::jack_transport_locate(client, frame); }
+
+	// Frames elapsed since the current cycle start (process thread).
+	static nframes_type frames_since_cycle_start ( const client_type *client )
+		{ return ::jack_frames_since_cycle_start(client); }
+};
+
+
+// end of jack_link_jack.hpp
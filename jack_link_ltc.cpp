@@ -0,0 +1,260 @@
+// jack_link_ltc.cpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "jack_link_ltc.hpp"
+
+#include "jack_link_log.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+//---------------------------------------------------------------------
+// jack_link_ltc -- impl.
+//
+
+// Highest sample rate catered for, without re-allocation.
+static const double c_ltc_srate_max = 192000.0;
+
+// Output peak level (-18 dBFS).
+static const float c_ltc_level = 0.125f;
+
+// Sync word (bits 64..79, in transmission order).
+static const uint8_t c_ltc_sync[16]
+	= { 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1 };
+
+
+// Constructor.
+jack_link_ltc::jack_link_ltc (void) :
+	m_base(25), m_fps(25.0), m_drop(false), m_level(c_ltc_level),
+	m_srate(0.0), m_frame_size(0.0),
+	m_cells(nullptr), m_ncells(0), m_ncells_max(0),
+	m_frame(0), m_frame_valid(false)
+{
+	std::fill_n(m_edges, c_frame_cells + 1, 0);
+	std::fill_n(m_levels, c_frame_cells, 0.0f);
+}
+
+
+// Destructor.
+jack_link_ltc::~jack_link_ltc (void)
+{
+	close();
+}
+
+
+// Frame rate setup ("24", "25", "29.97" (drop-frame) or "30").
+bool jack_link_ltc::open ( const std::string& fps, double srate )
+{
+	close();
+
+	if (!fps.compare("24")) {
+		m_base = 24;
+		m_fps = 24.0;
+		m_drop = false;
+	}
+	else
+	if (!fps.compare("25")) {
+		m_base = 25;
+		m_fps = 25.0;
+		m_drop = false;
+	}
+	else
+	if (!fps.compare("29.97")) {
+		m_base = 30;
+		m_fps = 30000.0 / 1001.0;
+		m_drop = true;
+	}
+	else
+	if (!fps.compare("30")) {
+		m_base = 30;
+		m_fps = 30.0;
+		m_drop = false;
+	}
+	else {
+		jack_link_log("Invalid LTC frame rate: %s.", fps.c_str());
+		return false;
+	}
+
+	// Rounded frame lengths may be one sample longer...
+	m_ncells_max = uint32_t(std::ceil(
+		std::max(srate, c_ltc_srate_max) / m_fps)) + 2;
+	m_cells = new uint16_t [m_ncells_max];
+
+	reset(srate);
+
+	jack_link_log("LTC output: %s fps%s.",
+		fps.c_str(), m_drop ? " (drop-frame)" : "");
+
+	return true;
+}
+
+
+void jack_link_ltc::close (void)
+{
+	if (m_cells) {
+		delete [] m_cells;
+		m_cells = nullptr;
+	}
+
+	m_ncells = 0;
+	m_ncells_max = 0;
+	m_frame_valid = false;
+}
+
+
+// Render one period (real-time safe).
+void jack_link_ltc::process ( float *buf, jack_nframes_t nframes,
+	jack_transport_state_t state, jack_nframes_t frame )
+{
+	if (m_cells == nullptr)
+		return;
+
+	// Silence while stopped (or out of range)...
+	if ((state != JackTransportRolling && state != JackTransportLooping)
+		|| m_ncells == 0) {
+		std::fill_n(buf, nframes, 0.0f);
+		return;
+	}
+
+	jack_nframes_t i = 0;
+	while (i < nframes) {
+		// Which LTC frame, starting at which (rounded) sample...
+		const uint64_t t = uint64_t(frame) + i;
+		uint64_t n = uint64_t(double(t) / m_frame_size);
+		uint64_t start = uint64_t(std::llround(double(n) * m_frame_size));
+		if (start > t)
+			start = uint64_t(std::llround(double(--n) * m_frame_size));
+		uint64_t end = uint64_t(std::llround(double(n + 1) * m_frame_size));
+		if (end <= t) {
+			start = end;
+			end = uint64_t(std::llround(double(++n + 1) * m_frame_size));
+		}
+		if (!m_frame_valid || m_frame != n)
+			encode(n);
+		// Runs of constant level, one per half-bit cell...
+		const uint32_t len = uint32_t(end - start);
+		uint32_t s = uint32_t(t - start);
+		while (i < nframes && s < len) {
+			const unsigned int k = m_cells[std::min(s, m_ncells - 1)];
+			const uint32_t e = (k + 1 < c_frame_cells ? m_edges[k + 1] : len);
+			const uint32_t run = std::min(e - s, nframes - i);
+			std::fill_n(buf + i, run, m_levels[k]);
+			i += run;
+			s += run;
+		}
+	}
+}
+
+
+// LTC frame (timecode address) encoding.
+void jack_link_ltc::encode ( uint64_t frame )
+{
+	m_frame = frame;
+	m_frame_valid = true;
+
+	// Drop-frame: skip labels 0 and 1 on every minute but each tenth...
+	uint64_t count = frame;
+	if (m_drop) {
+		const uint64_t d = count / 17982;
+		const uint64_t m = count % 17982;
+		count += 18 * d + (m < 2 ? 0 : 2 * ((m - 2) / 1798));
+	}
+
+	const unsigned int ff = count % m_base;
+	const uint64_t secs = count / m_base;
+	const unsigned int ss = secs % 60;
+	const unsigned int mm = (secs / 60) % 60;
+	const unsigned int hh = (secs / 3600) % 24;
+
+	uint8_t bits[c_frame_bits];
+	std::fill_n(bits, c_frame_bits, 0);
+
+	auto bcd = [&bits] ( unsigned int pos, unsigned int n, unsigned int v ) {
+		for (unsigned int j = 0; j < n; ++j)
+			bits[pos + j] = (v >> j) & 1;
+	};
+
+	bcd( 0, 4, ff % 10);
+	bcd( 8, 2, ff / 10);
+	bits[10] = (m_drop ? 1 : 0);
+	bcd(16, 4, ss % 10);
+	bcd(24, 3, ss / 10);
+	bcd(32, 4, mm % 10);
+	bcd(40, 3, mm / 10);
+	bcd(48, 4, hh % 10);
+	bcd(56, 2, hh / 10);
+
+	std::copy_n(c_ltc_sync, 16, bits + 64);
+
+	// Polarity correction: an even number of ones, so that every
+	// frame starts (and ends) on the same level...
+	const unsigned int polarity = (m_base == 25 ? 59 : 27);
+	unsigned int ones = 0;
+	for (unsigned int b = 0; b < c_frame_bits; ++b)
+		ones += bits[b];
+	bits[polarity] = (ones & 1);
+
+	// Biphase-mark: toggle on every bit start, and mid-bit on ones...
+	float v = -m_level;
+	for (unsigned int b = 0; b < c_frame_bits; ++b) {
+		v = -v;
+		m_levels[2 * b] = v;
+		if (bits[b])
+			v = -v;
+		m_levels[2 * b + 1] = v;
+	}
+}
+
+
+// Sample rate change (real-time safe, bounded).
+void jack_link_ltc::reset ( double srate )
+{
+	if (m_cells == nullptr)
+		return;
+
+	m_srate = srate;
+	m_frame_size = m_srate / m_fps;
+	m_frame_valid = false;
+
+	m_ncells = 0;
+	if (uint32_t(std::ceil(m_frame_size)) + 2 > m_ncells_max)
+		return;
+
+	for (unsigned int k = 0; k <= c_frame_cells; ++k) {
+		m_edges[k] = uint32_t(std::llround(
+			double(k) * m_frame_size / double(c_frame_cells)));
+	}
+
+	const uint32_t ncells = m_edges[c_frame_cells] + 1;
+
+	unsigned int k = 0;
+	for (uint32_t s = 0; s < ncells; ++s) {
+		while (k + 1 < c_frame_cells && s >= m_edges[k + 1])
+			++k;
+		m_cells[s] = uint16_t(k);
+	}
+
+	m_ncells = ncells;
+}
+
+
+// end of jack_link_ltc.cpp
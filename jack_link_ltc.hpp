@@ -0,0 +1,104 @@
+// jack_link_ltc.hpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#pragma once
+
+#include <jack/types.h>
+#include <jack/transport.h>
+
+#include <string>
+
+#include <cstdint>
+
+
+//---------------------------------------------------------------------
+// jack_link_ltc -- decl.
+//
+// SMPTE linear timecode (LTC) generator, following the JACK transport
+// frame position: each LTC frame is biphase-mark encoded once into a
+// half-bit level table, then rendered as runs of constant samples over
+// a pre-computed sample-to-cell table (real-time safe, allocation-free).
+//
+
+class jack_link_ltc
+{
+public:
+
+	// Constructor.
+	jack_link_ltc();
+
+	// Destructor.
+	~jack_link_ltc();
+
+	// Frame rate setup ("24", "25", "29.97" (drop-frame) or "30").
+	bool open(const std::string& fps, double srate);
+	void close();
+
+	bool active() const { return (m_cells != nullptr); }
+
+	double fps() const { return m_fps; }
+	bool drop() const { return m_drop; }
+
+	// Sample rate change (real-time safe, bounded).
+	void reset(double srate);
+
+	// Render one period (real-time safe).
+	void process(float *buf, jack_nframes_t nframes,
+		jack_transport_state_t state, jack_nframes_t frame);
+
+protected:
+
+	// LTC frame (timecode address) encoding.
+	void encode(uint64_t frame);
+
+private:
+
+	// LTC frame: 80 bits, 160 biphase half-bit cells.
+	static const unsigned int c_frame_bits = 80;
+	static const unsigned int c_frame_cells = 2 * c_frame_bits;
+
+	// Frame rate (nominal and actual).
+	unsigned int m_base;
+	double m_fps;
+	bool m_drop;
+
+	// Output level (peak).
+	float m_level;
+
+	// Samples per LTC frame (fractional).
+	double m_srate;
+	double m_frame_size;
+
+	// Half-bit cell boundaries (sample offsets into the frame)
+	// and sample offset to half-bit cell look-up.
+	uint32_t m_edges[c_frame_cells + 1];
+	uint16_t *m_cells;
+	uint32_t m_ncells;
+	uint32_t m_ncells_max;
+
+	// Current LTC frame, encoded.
+	uint64_t m_frame;
+	bool m_frame_valid;
+	float m_levels[c_frame_cells];
+};
+
+
+// end of jack_link_ltc.hpp
@@ -0,0 +1,245 @@
+// jack_link_main.cpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "jack_link.hpp"
+
+#include "jack_link_log.hpp"
+
+#include <iostream>
+#include <string>
+#include <csignal>
+
+
+// daemon mode stuff...
+//
+
+#include <sys/param.h>
+
+
+static bool daemon_started = false;
+
+
+void daemon_fork (void)
+{
+	const int pid = ::fork();
+	if (pid > 0)
+		::exit(0);
+	else 
+	if (pid < 0)
+		::exit(1);
+}
+
+
+void daemon_start (void)
+{
+	daemon_fork();
+
+	::setsid();
+
+	daemon_fork();
+
+	for(int fd = 0; fd < NOFILE; ++fd)
+		::close(fd);
+	
+	::chdir("/tmp");
+	::umask(0);
+
+	daemon_started = true;
+}
+
+
+// main line stuff...
+//
+
+void sig_handler ( int sig_no )
+{
+	if (daemon_started) {
+		jack_link_log("Daemon is terminating with signal %d (SIG%s).", sig_no, ::sigabbrev_np(sig_no));
+		daemon_started = false;
+	//	::exit(sig_no);
+	} else {
+		::fclose(stdin);
+		std::cerr << std::endl;
+	}
+}
+
+
+void version (void)
+{
+	jack_link_log(JACK_LINK_NAME " v" JACK_LINK_VERSION " (Link v" ABLETON_LINK_VERSION ")");
+}
+
+
+void usage (void)
+{
+	std::cout << std::endl;
+	std::cout << "Usage: " << JACK_LINK_NAME << " [options]" << std::endl;
+	std::cout << std::endl;
+	std::cout << "Options:" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -n, --name <name>" << std::endl;
+	std::cout << "\tClient name (default = '" JACK_LINK_NAME "')" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -q, --quiet" << std::endl;
+	std::cout << "\tRun as quiet as a daemon (default = no)" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -d, --daemon" << std::endl;
+	std::cout << "\tRun in the background as a daemon (default = no)" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -O, --observer" << std::endl;
+	std::cout << "\tObserve divergence only, never take timebase nor transport (default = no)" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -o, --osc [<host>:]<port>" << std::endl;
+	std::cout << "\tBroadcast beat/phase OSC bundles over UDP (default = none)" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -l, --ltc <fps>" << std::endl;
+	std::cout << "\tRender SMPTE LTC on an audio output port: 24, 25, 29.97 (drop-frame) or 30 (default = none)" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -r, --tempo-rate <hz>" << std::endl;
+	std::cout << "\tMaximum JACK to Link tempo update rate (default = 10)" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -H, --tempo-hysteresis <bpm>" << std::endl;
+	std::cout << "\tMinimum JACK to Link tempo change (default = 0.01)" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -R, --ramp <beats>" << std::endl;
+	std::cout << "\tRamp tempo changes over a number of beats (default = 0, none)" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  --ramp-curve <curve>" << std::endl;
+	std::cout << "\tTempo ramp curve: linear or exponential (default = linear)" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -a, --at \"<when> <command> [<value>]\"" << std::endl;
+	std::cout << "\tSchedule a command on the Link beat timeline, where <when> is a beat," << std::endl;
+	std::cout << "\t\"bar <n>\" or \"next\" (downbeat) and <command> is \"tempo <bpm>\"," << std::endl;
+	std::cout << "\t\"start\", \"stop\" or \"quantum <beats>\" (default = none)" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -f, --file <script>" << std::endl;
+	std::cout << "\tSchedule commands from a script file, one per line (default = none)" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -C, --control <path>" << std::endl;
+	std::cout << "\tRead commands from a named pipe, one per line (default = none)" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -s, --supervised" << std::endl;
+	std::cout << "\tStay on Link and reconnect when JACK goes away (default = no)" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -h, --help" << std::endl;
+	std::cout << "\tShow this help about command line options" << std::endl;
+	std::cout << std::endl;
+}
+
+
+int main ( int argc, char **argv )
+{
+	::signal(SIGABRT, &sig_handler);
+	::signal(SIGHUP,  &sig_handler);
+	::signal(SIGINT,  &sig_handler);
+	::signal(SIGQUIT, &sig_handler);
+	::signal(SIGTERM, &sig_handler);
+
+	std::string name = JACK_LINK_NAME;
+	bool quiet = false;
+	bool daemon = false;
+
+	jack_link_options options;
+
+	for (int i = 1; i < argc; ++i) {
+		if (options.parse(i, argc, argv))
+			continue;
+		const std::string arg = argv[i];
+		if (!arg.compare("-n") || !arg.compare("--name")) {
+			if (++i < argc) {
+				name = argv[i];
+				if (name.empty()) {
+					std::cerr << "Invalid empty name" << std::endl;
+					return 2;
+				}
+			}
+		}
+		else
+		if (!arg.compare("-q") || !arg.compare("--quiet")) {
+			quiet = true;
+		}
+		else
+		if (!arg.compare("-d") || !arg.compare("--daemon")) {
+			daemon = true;
+		}
+		else
+		if (!arg.compare("-h") || !arg.compare("--help")) {
+			usage();
+			return 1;
+		}
+	}
+
+	jack_link_log logger;
+
+	if (daemon)
+		daemon_start();
+
+	if (daemon_started) {
+		logger.start(JACK_LINK_NAME, name);
+		jack_link_log("Daemon is starting with PID %u...", ::getpid());
+	}
+
+	if (!quiet)
+		version();
+
+	// Have termination signals blocked on all threads
+	// but while the daemon loop is suspended below...
+	sigset_t sig_mask, sig_omask;
+	::sigemptyset(&sig_mask);
+	::sigaddset(&sig_mask, SIGABRT);
+	::sigaddset(&sig_mask, SIGHUP);
+	::sigaddset(&sig_mask, SIGINT);
+	::sigaddset(&sig_mask, SIGQUIT);
+	::sigaddset(&sig_mask, SIGTERM);
+	if (daemon)
+		::pthread_sigmask(SIG_BLOCK, &sig_mask, &sig_omask);
+
+	jack_link app(name, options);
+
+	// Enter daemon loop (background)...
+	//
+	if (daemon) {
+		while (daemon_started)
+			::sigsuspend(&sig_omask);
+		::pthread_sigmask(SIG_SETMASK, &sig_omask, nullptr);
+		app.terminate();
+		jack_link_log("Daemon terminated.");
+		logger.stop();
+		return 0;
+	}
+
+	// Enter interactive loop (foreground)...
+	//
+	std::string line;
+
+	while (!std::cin.eof() && app.active()) {
+		if (!quiet)
+			std::cout << app.name() << "> ";
+		std::getline(std::cin, line);
+		if (!app.command(line, std::cout))
+			break;
+	}
+
+	return 0;
+}
+
+
+// end of jack_link_main.cpp
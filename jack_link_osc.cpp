@@ -0,0 +1,376 @@
+// jack_link_osc.cpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "jack_link_osc.hpp"
+
+#include "jack_link_log.hpp"
+
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <unistd.h>
+
+
+//---------------------------------------------------------------------
+// jack_link_osc -- impl.
+//
+
+// Seconds from NTP epoch (1900) to UNIX epoch (1970).
+static const uint64_t c_ntp_epoch = 2208988800ULL;
+
+
+// Constructor.
+jack_link_osc::jack_link_osc ( const ableton::Link::Clock& clock ) :
+	m_packets(nullptr), m_read(0), m_write(0),
+	m_packet(nullptr), m_bundle(0), m_message(0), m_overflow(false),
+	m_clock(clock), m_clock_offset(0), m_sock(-1),
+	m_running(false), m_thread(nullptr)
+{
+}
+
+
+// Destructor.
+jack_link_osc::~jack_link_osc (void)
+{
+	close();
+}
+
+
+// Open/close UDP destination ("[host:]port").
+bool jack_link_osc::open ( const std::string& addr )
+{
+	close();
+
+	std::string host = "127.0.0.1";
+	std::string port = addr;
+	const std::string::size_type pos = addr.find_last_of(':');
+	if (pos != std::string::npos) {
+		host = addr.substr(0, pos);
+		port = addr.substr(pos + 1);
+	}
+
+	struct addrinfo hints;
+	::memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_DGRAM;
+
+	struct addrinfo *res = nullptr;
+	const int err = ::getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+	if (err) {
+		jack_link_log("Could not resolve OSC address: %s (%s).",
+			addr.c_str(), ::gai_strerror(err));
+		return false;
+	}
+
+	for (struct addrinfo *ai = res; ai && m_sock < 0; ai = ai->ai_next) {
+		m_sock = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (m_sock >= 0 && ::connect(m_sock, ai->ai_addr, ai->ai_addrlen) < 0) {
+			::close(m_sock);
+			m_sock = -1;
+		}
+	}
+
+	::freeaddrinfo(res);
+
+	if (m_sock < 0) {
+		jack_link_log("Could not open OSC address: %s.", addr.c_str());
+		return false;
+	}
+
+	m_packets = new packet [c_packet_count];
+	m_read = 0;
+	m_write = 0;
+
+	clock_sync();
+
+	m_running = true;
+	m_thread = new std::thread([this]{ sender_start(); });
+
+	jack_link_log("OSC output: %s:%s.", host.c_str(), port.c_str());
+
+	return true;
+}
+
+
+void jack_link_osc::close (void)
+{
+	sender_stop();
+
+	if (m_thread) {
+		m_thread->join();
+		delete m_thread;
+		m_thread = nullptr;
+	}
+
+	if (m_sock >= 0) {
+		::close(m_sock);
+		m_sock = -1;
+	}
+
+	if (m_packets) {
+		delete [] m_packets;
+		m_packets = nullptr;
+	}
+}
+
+
+// Host time to OSC (NTP) time-tag conversion.
+uint64_t jack_link_osc::timetag ( std::chrono::microseconds host_time ) const
+{
+	const int64_t usecs = host_time.count() + m_clock_offset;
+	const uint64_t secs = uint64_t(usecs / 1000000) + c_ntp_epoch;
+	const uint64_t frac = (uint64_t(usecs % 1000000) << 32) / 1000000;
+	return (secs << 32) | frac;
+}
+
+
+// Packet building (real-time safe, allocation-free).
+bool jack_link_osc::begin (void)
+{
+	if (m_packets == nullptr)
+		return false;
+
+	const std::size_t w = m_write.load(std::memory_order_relaxed);
+	if (w - m_read.load(std::memory_order_acquire) >= c_packet_count)
+		return false;
+
+	m_packet = &m_packets[w % c_packet_count];
+	m_packet->size = 0;
+	m_bundle = 0;
+	m_message = 0;
+	m_overflow = false;
+
+	// Outer bundle: to be dispatched immediately...
+	write_string("#bundle");
+	write_int64(1);
+
+	return true;
+}
+
+
+void jack_link_osc::bundle ( uint64_t timetag )
+{
+	if (m_packet == nullptr)
+		return;
+
+	bundle_close();
+
+	m_bundle = m_packet->size;
+	write_int32(0);
+	write_string("#bundle");
+	write_int64(timetag);
+}
+
+
+void jack_link_osc::message ( const char *path,
+	double beat, double phase, double tempo, double quantum, bool playing )
+{
+	if (m_packet == nullptr)
+		return;
+
+	message_open(path, ",dfffi");
+	write_double(beat);
+	write_float(float(phase));
+	write_float(float(tempo));
+	write_float(float(quantum));
+	write_int32(playing ? 1 : 0);
+	message_close();
+}
+
+
+void jack_link_osc::message ( const char *path, double tempo )
+{
+	if (m_packet == nullptr)
+		return;
+
+	message_open(path, ",f");
+	write_float(float(tempo));
+	message_close();
+}
+
+
+void jack_link_osc::end (void)
+{
+	if (m_packet == nullptr)
+		return;
+
+	bundle_close();
+
+	// Drop whatever did not fit...
+	if (!m_overflow)
+		m_write.fetch_add(1, std::memory_order_release);
+
+	m_packet = nullptr;
+}
+
+
+// Wake up the sender, when anything is pending (real-time safe).
+void jack_link_osc::notify (void)
+{
+	if (m_read.load(std::memory_order_relaxed)
+		== m_write.load(std::memory_order_relaxed))
+		return;
+
+	// Otherwise retried on next cycle...
+	if (m_mutex.try_lock()) {
+		m_cond.notify_one();
+		m_mutex.unlock();
+	}
+}
+
+
+// Raw packet writers.
+bool jack_link_osc::reserve ( std::size_t n )
+{
+	if (m_overflow || m_packet->size + n > c_packet_size)
+		m_overflow = true;
+
+	return !m_overflow;
+}
+
+
+void jack_link_osc::write_int32 ( uint32_t v )
+{
+	if (!reserve(4))
+		return;
+
+	unsigned char *data = m_packet->data + m_packet->size;
+	data[0] = (v >> 24) & 0xff;
+	data[1] = (v >> 16) & 0xff;
+	data[2] = (v >>  8) & 0xff;
+	data[3] = (v      ) & 0xff;
+	m_packet->size += 4;
+}
+
+
+void jack_link_osc::write_int64 ( uint64_t v )
+{
+	write_int32(uint32_t(v >> 32));
+	write_int32(uint32_t(v & 0xffffffff));
+}
+
+
+void jack_link_osc::write_float ( float v )
+{
+	uint32_t u;
+	::memcpy(&u, &v, sizeof(u));
+	write_int32(u);
+}
+
+
+void jack_link_osc::write_double ( double v )
+{
+	uint64_t u;
+	::memcpy(&u, &v, sizeof(u));
+	write_int64(u);
+}
+
+
+void jack_link_osc::write_string ( const char *s )
+{
+	const std::size_t len = ::strlen(s) + 1;
+	const std::size_t n = (len + 3) & ~std::size_t(3);
+	if (!reserve(n))
+		return;
+
+	unsigned char *data = m_packet->data + m_packet->size;
+	::memcpy(data, s, len);
+	::memset(data + len, 0, n - len);
+	m_packet->size += n;
+}
+
+
+void jack_link_osc::bundle_close (void)
+{
+	if (m_bundle > 0 && !m_overflow) {
+		const std::size_t size = m_packet->size;
+		m_packet->size = m_bundle;
+		write_int32(uint32_t(size - m_bundle - 4));
+		m_packet->size = size;
+	}
+
+	m_bundle = 0;
+}
+
+
+void jack_link_osc::message_open ( const char *path, const char *types )
+{
+	m_message = m_packet->size;
+	write_int32(0);
+	write_string(path);
+	write_string(types);
+}
+
+
+void jack_link_osc::message_close (void)
+{
+	if (!m_overflow) {
+		const std::size_t size = m_packet->size;
+		m_packet->size = m_message;
+		write_int32(uint32_t(size - m_message - 4));
+		m_packet->size = size;
+	}
+
+	m_message = 0;
+}
+
+
+// Host to wall-clock time offset.
+void jack_link_osc::clock_sync (void)
+{
+	const auto wall_time
+		= std::chrono::duration_cast<std::chrono::microseconds> (
+			std::chrono::system_clock::now().time_since_epoch());
+	m_clock_offset = wall_time.count() - m_clock.micros().count();
+}
+
+
+// Sender thread.
+void jack_link_osc::sender_start (void)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (m_running) {
+		clock_sync();
+		std::size_t r = m_read.load(std::memory_order_relaxed);
+		while (r != m_write.load(std::memory_order_acquire)) {
+			const packet& p = m_packets[r % c_packet_count];
+			::send(m_sock, p.data, p.size, 0);
+			m_read.store(++r, std::memory_order_release);
+		}
+		m_cond.wait(lock);
+	}
+}
+
+
+void jack_link_osc::sender_stop (void)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_running) {
+		m_running = false;
+		m_cond.notify_all();
+	}
+}
+
+
+// end of jack_link_osc.cpp
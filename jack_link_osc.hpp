@@ -0,0 +1,132 @@
+// jack_link_osc.hpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#pragma once
+
+#include <ableton/Link.hpp>
+
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include <cstdint>
+
+
+//---------------------------------------------------------------------
+// jack_link_osc -- decl.
+//
+// OSC-over-UDP beat/phase broadcaster: packets are built in place on a
+// pre-allocated ring (real-time thread) and sent from a worker thread.
+//
+
+class jack_link_osc
+{
+public:
+
+	// Constructor.
+	jack_link_osc(const ableton::Link::Clock& clock);
+
+	// Destructor.
+	~jack_link_osc();
+
+	// Open/close UDP destination ("[host:]port").
+	bool open(const std::string& addr);
+	void close();
+
+	bool active() const { return (m_sock >= 0); }
+
+	// Host time to OSC (NTP) time-tag conversion.
+	uint64_t timetag(std::chrono::microseconds host_time) const;
+
+	// Packet building (real-time safe, allocation-free).
+	bool begin();
+	void bundle(uint64_t timetag);
+	void message(const char *path,
+		double beat, double phase, double tempo,
+		double quantum, bool playing);
+	void message(const char *path, double tempo);
+	void end();
+
+	// Wake up the sender, when anything is pending (real-time safe).
+	void notify();
+
+protected:
+
+	// Raw packet writers.
+	bool reserve(std::size_t n);
+	void write_int32(uint32_t v);
+	void write_int64(uint64_t v);
+	void write_float(float v);
+	void write_double(double v);
+	void write_string(const char *s);
+
+	void bundle_close();
+	void message_open(const char *path, const char *types);
+	void message_close();
+
+	// Host to wall-clock time offset.
+	void clock_sync();
+
+	// Sender thread.
+	void sender_start();
+	void sender_stop();
+
+private:
+
+	// Packet ring buffer.
+	static const std::size_t c_packet_size = 1472;
+	static const std::size_t c_packet_count = 32;
+
+	struct packet
+	{
+		std::size_t size;
+		unsigned char data[c_packet_size];
+	};
+
+	packet *m_packets;
+	std::atomic<std::size_t> m_read;
+	std::atomic<std::size_t> m_write;
+
+	// Packet being built.
+	packet *m_packet;
+	std::size_t m_bundle;
+	std::size_t m_message;
+	bool m_overflow;
+
+	// Time-tag conversion.
+	ableton::Link::Clock m_clock;
+	std::atomic<int64_t> m_clock_offset;
+
+	// Socket state.
+	int m_sock;
+
+	// Sender state.
+	bool m_running;
+	std::thread *m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+};
+
+
+// end of jack_link_osc.hpp
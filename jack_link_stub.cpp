@@ -0,0 +1,521 @@
+// jack_link_stub.cpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "jack_link_core.hpp"
+
+#include <cassert>
+#include <cstdio>
+
+
+// In-memory stub policies...
+//
+// A minimal transport and Link session over which the whole bridge
+// core gets instantiated, with neither libjack nor Link headers
+// around, then driven cycle by cycle through a few scenarios, on a
+// settable clock (see "make check").
+//
+
+//---------------------------------------------------------------------
+// jack_link_stub_transport -- in-memory transport policy.
+//
+
+struct jack_link_stub_transport
+{
+	typedef uint32_t nframes_type;
+
+	enum state_type { Stopped = 0, Rolling, Starting };
+
+	struct position_type
+	{
+		uint32_t frame_rate = 48000;
+		uint32_t frame = 0;
+		bool valid = false;
+		int32_t bar = 0;
+		int32_t beat = 0;
+		int32_t tick = 0;
+		double bar_start_tick = 0.0;
+		float beats_per_bar = 0.0f;
+		float beat_type = 0.0f;
+		double ticks_per_beat = 0.0;
+		double beats_per_minute = 0.0;
+		uint32_t bbt_offset = 0;
+		double tick_double = 0.0;
+	};
+
+	// Transport engine state, as of the current cycle, and
+	// requests pending for the next one.
+	struct client_type
+	{
+		state_type state = Stopped;
+		position_type pos;
+		bool start_req = false;
+		bool stop_req = false;
+		bool locate_req = false;
+		uint32_t locate_frame = 0;
+	};
+
+	static bool rolling ( state_type state )
+		{ return (state == Rolling); }
+
+	static bool starting ( state_type state )
+		{ return (state == Starting); }
+
+	static bool bbt ( const position_type *pos )
+		{ return pos->valid; }
+
+	static bool bbt_offset ( const position_type *pos )
+		{ return pos->valid; }
+
+	static void set_bbt ( position_type *pos )
+		{ pos->valid = true; }
+
+	static bool tick_double ( const position_type *pos, double& tick )
+		{ tick = pos->tick_double; return pos->valid; }
+
+	static void set_tick_double ( position_type *pos, double tick )
+		{ pos->tick_double = tick; }
+
+	static state_type query (
+		const client_type *client, position_type *pos )
+	{
+		if (pos)
+			*pos = client->pos;
+		return client->state;
+	}
+
+	static void start ( client_type *client )
+		{ client->start_req = true; }
+
+	static void stop ( client_type *client )
+		{ client->stop_req = true; }
+
+	static void locate ( client_type *client, nframes_type frame )
+		{ client->locate_req = true; client->locate_frame = frame; }
+
+	static nframes_type frames_since_cycle_start ( const client_type * )
+		{ return 0; }
+};
+
+
+//---------------------------------------------------------------------
+// jack_link_stub_link -- in-memory Link session policy.
+//
+
+class jack_link_stub_link
+{
+public:
+
+	class Clock
+	{
+	public:
+
+		Clock(const std::chrono::microseconds *time) : m_time(time) {}
+
+		std::chrono::microseconds micros() const
+			{ return *m_time; }
+
+	private:
+
+		const std::chrono::microseconds *m_time;
+	};
+
+	// Timeline: beats at some time, on a constant tempo.
+	class SessionState
+	{
+	public:
+
+		SessionState(double tempo = 120.0)
+			: m_tempo(tempo), m_beat(0.0), m_time(0),
+				m_playing(false), m_playing_time(0) {}
+
+		double tempo() const
+			{ return m_tempo; }
+		void setTempo(double tempo, std::chrono::microseconds time)
+			{ m_beat = beatAtTime(time, 1.0); m_time = time; m_tempo = tempo; }
+
+		double beatAtTime(std::chrono::microseconds time, double) const
+			{ return m_beat + m_tempo * double((time - m_time).count()) / 60.0e6; }
+		double phaseAtTime(std::chrono::microseconds time, double quantum) const
+		{
+			const double beat = beatAtTime(time, quantum);
+			return beat - quantum * std::floor(beat / quantum);
+		}
+		std::chrono::microseconds timeAtBeat(double beat, double) const
+		{
+			return m_time + std::chrono::microseconds(
+				std::llround(60.0e6 * (beat - m_beat) / m_tempo));
+		}
+
+		void forceBeatAtTime(double beat, std::chrono::microseconds time, double)
+			{ m_beat = beat; m_time = time; }
+
+		void setIsPlaying(bool playing, std::chrono::microseconds time)
+			{ m_playing = playing; m_playing_time = time; }
+		bool isPlaying() const
+			{ return m_playing; }
+		std::chrono::microseconds timeForIsPlaying() const
+			{ return m_playing_time; }
+
+	private:
+
+		double m_tempo;
+		double m_beat;
+		std::chrono::microseconds m_time;
+		bool m_playing;
+		std::chrono::microseconds m_playing_time;
+	};
+
+	jack_link_stub_link(double tempo) : m_state(tempo), m_time(0) {}
+
+	Clock clock() const
+		{ return Clock(&m_time); }
+
+	void set_time(std::chrono::microseconds time)
+		{ m_time = time; }
+
+	SessionState captureAudioSessionState() const
+		{ return m_state; }
+	void commitAudioSessionState(const SessionState& state)
+		{ m_state = state; }
+
+private:
+
+	SessionState m_state;
+	std::chrono::microseconds m_time;
+};
+
+
+// Explicit instantiation: the whole core, every member function.
+template class jack_link_core<jack_link_stub_transport, jack_link_stub_link>;
+
+
+//---------------------------------------------------------------------
+// jack_link_stub -- the core, driven one cycle at a time.
+//
+
+class jack_link_stub
+	: public jack_link_core<jack_link_stub_transport, jack_link_stub_link>
+{
+public:
+
+	typedef jack_link_stub_transport Transport;
+
+	static const nframes_type c_nframes = 256;
+	static const nframes_type c_srate = 48000;
+
+	jack_link_stub() : jack_link_core(&m_jack), m_time(0)
+	{
+		config_setup(c_srate, c_nframes);
+		m_jack.pos.frame_rate = c_srate;
+	}
+
+	// One JACK cycle: process callback (clock at the cycle start),
+	// then the timebase callback, with the next cycle position.
+	void cycle()
+	{
+		m_link.set_time(m_time);
+
+		position_type pos;
+		const state_type state = Transport::query(&m_jack, &pos);
+
+		schedule_process(state, c_nframes, &pos);
+		if (m_transport_req != TransportNone)
+			transport_process(state, c_nframes, &pos);
+
+		// Transport engine, on to the next cycle...
+		int new_pos = 0;
+		if (Transport::rolling(m_jack.state))
+			m_jack.pos.frame += c_nframes;
+		if (m_jack.locate_req) {
+			m_jack.locate_req = false;
+			m_jack.pos.frame = m_jack.locate_frame;
+			new_pos = 1;
+		}
+		if (m_jack.stop_req) {
+			m_jack.stop_req = false;
+			m_jack.state = Transport::Stopped;
+		}
+		else
+		if (m_jack.state == Transport::Starting)
+			m_jack.state = Transport::Rolling;
+		else
+		if (m_jack.start_req && m_jack.state == Transport::Stopped)
+			m_jack.state = Transport::Starting;
+		m_jack.start_req = false;
+
+		if (Transport::rolling(m_jack.state) || new_pos)
+			timebase_process(m_jack.state, c_nframes, &m_jack.pos, new_pos);
+
+		m_time += period(c_nframes);
+	}
+
+	void run(unsigned int ncycles)
+		{ while (ncycles-- > 0) cycle(); }
+
+	// Absolute beats of some (published) position.
+	static double beats(const position_type& pos)
+	{
+		return double(pos.bar - 1) * pos.beats_per_bar
+			+ double(pos.beat - 1) + pos.tick_double / pos.ticks_per_beat;
+	}
+
+	// Beats per cycle, at some tempo.
+	static double cycle_beats(double tempo)
+		{ return tempo * c_nframes / (60.0 * c_srate); }
+
+	// Host time when some cycle frame gets heard.
+	std::chrono::microseconds heard_time(nframes_type frame) const
+	{
+		return m_time + m_period + std::chrono::microseconds(std::llround(
+			1.0e6 * (double(frame) - double(m_jack.pos.frame)) / c_srate));
+	}
+
+	void roll(nframes_type frame)
+	{
+		m_jack.state = Transport::Rolling;
+		m_jack.pos.frame = frame;
+		timebase_process(m_jack.state, c_nframes, &m_jack.pos, 1);
+	}
+
+	client_type m_jack;
+	std::chrono::microseconds m_time;
+
+	// Scenarios.
+	static void rolling();
+	static void long_frames();
+	static void relocation();
+	static void ramp();
+	static void ramp_freewheel();
+	static void ramp_tempo();
+	static void start();
+	static void schedule();
+};
+
+
+// Constant tempo, continuous BBT from the zero anchor on.
+void jack_link_stub::rolling (void)
+{
+	jack_link_stub stub;
+	stub.roll(0);
+	double beats = jack_link_stub::beats(stub.m_jack.pos);
+	assert(std::abs(beats) < 1e-9);
+	for (int i = 0; i < 1000; ++i) {
+		stub.cycle();
+		const double next = jack_link_stub::beats(stub.m_jack.pos);
+		assert(std::abs(next - beats - cycle_beats(120.0)) < 1e-9);
+		beats = next;
+	}
+}
+
+
+// Frames past 2^31 (12.4h at 48kHz) still on the zero anchor.
+void jack_link_stub::long_frames (void)
+{
+	jack_link_stub stub;
+	const nframes_type frame = 0x80000000u - 8 * c_nframes;
+	stub.roll(frame);
+	double beats = jack_link_stub::beats(stub.m_jack.pos);
+	for (int i = 0; i < 16; ++i) {
+		stub.cycle();
+		const position_type& pos = stub.m_jack.pos;
+		const double next = jack_link_stub::beats(pos);
+		assert(pos.bar > 0);
+		assert(std::abs(next - beats - cycle_beats(120.0)) < 1e-6);
+		assert(std::abs(next - 120.0 * pos.frame / (60.0 * c_srate)) < 1e-6);
+		beats = next;
+	}
+}
+
+
+// JACK relocations pin the Link beat on the new position, as heard.
+void jack_link_stub::relocation (void)
+{
+	jack_link_stub stub;
+	stub.m_playing = true;
+	stub.roll(0);
+	stub.run(100);
+	const unsigned long relocations = stub.m_relocations;
+	Transport::locate(&stub.m_jack, 12345 * 16);
+	stub.cycle();
+	assert(stub.m_relocations == relocations + 1);
+	const position_type& pos = stub.m_jack.pos;
+	const double quantum = pos.beats_per_bar;
+	const auto session_state = stub.m_link.captureAudioSessionState();
+	const double phase = session_state.phaseAtTime(
+		stub.heard_time(pos.frame), quantum);
+	const double beats = jack_link_stub::beats(pos);
+	assert(std::abs(divergence(phase - beats, quantum)) < 1e-3);
+}
+
+
+// Ramps end on target tempo, ramp length beats later.
+void jack_link_stub::ramp (void)
+{
+	jack_link_stub stub;
+	stub.ramp_setup(8.0, RampLinear, 10.0);
+	stub.roll(0);
+	stub.run(100);
+	const double beats0 = jack_link_stub::beats(stub.m_jack.pos);
+	stub.m_ramp_req = 140.0;
+	stub.cycle();
+	assert(stub.m_ramp);
+	double beats = jack_link_stub::beats(stub.m_jack.pos);
+	int ncycles = 0;
+	while (stub.m_ramp && ++ncycles < 10000) {
+		stub.cycle();
+		const double next = jack_link_stub::beats(stub.m_jack.pos);
+		assert(next - beats >= cycle_beats(120.0) - 1e-9);
+		assert(next - beats <= cycle_beats(140.0) + 1e-9);
+		beats = next;
+	}
+	assert(!stub.m_ramp && stub.m_tempo == 140.0);
+	assert(std::abs(beats - beats0 - 8.0) < 2.0 * cycle_beats(140.0));
+	assert(stub.m_link.captureAudioSessionState().tempo() == 140.0);
+}
+
+
+// Ramps frozen while freewheeling carry on at target tempo.
+void jack_link_stub::ramp_freewheel (void)
+{
+	jack_link_stub stub;
+	stub.ramp_setup(4.0, RampExponential, 10.0);
+	stub.roll(0);
+	stub.m_ramp_req = 140.0;
+	stub.run(10);
+	assert(stub.m_ramp);
+	stub.freewheel_process(1);
+	double beats = jack_link_stub::beats(stub.m_jack.pos);
+	for (int i = 0; i < 2000; ++i) {
+		stub.cycle();
+		const position_type& pos = stub.m_jack.pos;
+		const double next = jack_link_stub::beats(pos);
+		assert(pos.beats_per_minute <= 140.0 + 1e-9);
+		assert(next - beats >= cycle_beats(120.0) - 1e-9);
+		beats = next;
+	}
+	assert(stub.m_jack.pos.beats_per_minute == 140.0);
+	stub.freewheel_process(0);
+	stub.cycle();
+	assert(!stub.m_ramp && stub.m_tempo == 140.0);
+}
+
+
+// Ramp echoes dropped, peer tempo changes applied once done.
+void jack_link_stub::ramp_tempo (void)
+{
+	jack_link_stub stub;
+	stub.ramp_setup(8.0, RampLinear, 10.0);
+	stub.roll(0);
+	stub.m_ramp_req = 140.0;
+	stub.run(50);
+	assert(stub.m_ramp);
+	// Own commit, echoed back (Link microseconds per beat)...
+	stub.m_tempo_req = 60.0e6 / std::round(60.0e6 / stub.m_echo[0]);
+	stub.cycle();
+	assert(stub.m_tempo_req == 0.0);
+	// Some peer, meanwhile...
+	stub.m_tempo_req = 100.0;
+	while (stub.m_ramp)
+		stub.cycle();
+	assert(stub.m_tempo == 140.0 && stub.m_tempo_req == 100.0);
+	stub.run(c_srate / c_nframes + 1);
+	assert(stub.m_tempo == 100.0 && stub.m_tempo_req == 0.0);
+}
+
+
+// Quantum aligned starts, on a re-anchored tempo map.
+void jack_link_stub::start (void)
+{
+	jack_link_stub stub;
+	stub.roll(0);
+	stub.run(100);
+	stub.schedule_post(
+		stub.m_link.captureAudioSessionState().beatAtTime(
+			stub.m_time, 4.0) + 1.5, ScheduleTempo, 133.0);
+	stub.run(200);
+	assert(stub.m_tempo == 133.0 && stub.m_anchor_frame > 0);
+	Transport::stop(&stub.m_jack);
+	stub.run(10);
+	assert(stub.m_jack.state == Transport::Stopped);
+
+	// Link starts playing, JACK follows...
+	stub.m_playing = true;
+	stub.m_transport_req = TransportStart;
+	stub.cycle();
+	int ncycles = 0;
+	while (!Transport::rolling(stub.m_jack.state) && ++ncycles < 1000)
+		stub.cycle();
+	assert(Transport::rolling(stub.m_jack.state));
+
+	// First bar start rolled, heard on the Link quantum boundary...
+	const position_type& pos = stub.m_jack.pos;
+	const double beats = jack_link_stub::beats(pos);
+	const double bar_beats = pos.beats_per_bar * std::ceil(
+		beats / pos.beats_per_bar - 1e-9);
+	const nframes_type frame = pos.frame + nframes_type(std::llround(
+		(bar_beats - beats) * 60.0 * c_srate / pos.beats_per_minute));
+	const double phase = stub.m_link.captureAudioSessionState().phaseAtTime(
+		stub.heard_time(frame), pos.beats_per_bar);
+	assert(std::abs(divergence(phase, pos.beats_per_bar)) < 1e-3);
+}
+
+
+// Scheduled tempo changes, in place.
+void jack_link_stub::schedule (void)
+{
+	jack_link_stub stub;
+	stub.roll(0);
+	stub.run(10);
+	const double beat = stub.m_link.captureAudioSessionState().beatAtTime(
+		stub.m_time, 4.0);
+	stub.schedule_post(beat + 4.0, ScheduleTempo, 90.0);
+	stub.schedule_post(beat + 2.0, ScheduleQuantum, 3.0);
+	double beats = jack_link_stub::beats(stub.m_jack.pos);
+	for (int i = 0; i < 500; ++i) {
+		stub.cycle();
+		const double next = jack_link_stub::beats(stub.m_jack.pos);
+		assert(next > beats);
+		assert(next - beats <= cycle_beats(120.0) + 1e-9);
+		beats = next;
+	}
+	assert(stub.m_tempo == 90.0 && stub.m_quantum == 3.0);
+	assert(stub.m_nschedule == 0);
+}
+
+
+int main ( int /*argc*/, char ** /*argv*/ )
+{
+	jack_link_stub::rolling();
+	jack_link_stub::long_frames();
+	jack_link_stub::relocation();
+	jack_link_stub::ramp();
+	jack_link_stub::ramp_freewheel();
+	jack_link_stub::ramp_tempo();
+	jack_link_stub::start();
+	jack_link_stub::schedule();
+
+	::printf("jack_link_check: ok.\n");
+
+	return 0;
+}
+
+
+// end of jack_link_stub.cpp
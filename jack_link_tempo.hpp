@@ -0,0 +1,172 @@
+// jack_link_tempo.hpp
+//
+/****************************************************************************
+   Copyright (C) 2017-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include <cstdint>
+
+
+//---------------------------------------------------------------------
+// jack_link_tempo -- frame-beat tempo map (snapshot).
+//
+// Constant tempo from some anchor frame on, or else a tempo ramp in
+// progress, all in closed form; as published by the timebase master
+// (see jack_link_core) and used for the batch conversions alike.
+//
+
+struct jack_link_tempo
+{
+	// Tempo ramp curves.
+	enum { RampLinear = 0, RampExponential };
+
+	// Constant tempo: beats at some anchor frame.
+	uint32_t anchor_frame = 0;
+	double anchor_beats = 0.0;
+	double tempo = 0.0;
+
+	// Tempo ramp in progress, if any: start frame, beats and tempo,
+	// target tempo, length (beats), duration (frames) and curve.
+	int ramp = 0;
+	int ramp_curve = RampLinear;
+	uint32_t ramp_frame = 0;
+	uint32_t ramp_frames = 0;
+	double ramp_beats = 0.0;
+	double ramp_tempo0 = 0.0;
+	double ramp_tempo1 = 0.0;
+	double ramp_length = 0.0;
+
+	double srate = 0.0;
+
+	// Ramp beats (and tempo) some seconds into it, and back.
+	static double ramp_curve_beats(int curve,
+		double t0, double t1, double length,
+		double secs, double& beats_per_minute);
+	static double ramp_curve_secs(int curve,
+		double t0, double t1, double length, double beats);
+
+	// Beats at some frame, and back (fractional frame).
+	double beats(uint32_t frame) const;
+	double frame(double beats) const;
+
+	// Frames from some anchor on (negative before it, but never
+	// wrapping past 2^31 from a lower anchor, eg. zero).
+	static double frame_delta(uint32_t frame, uint32_t anchor);
+};
+
+
+//---------------------------------------------------------------------
+// jack_link_tempo -- impl.
+//
+
+inline double jack_link_tempo::ramp_curve_beats ( int curve,
+	double t0, double t1, double length,
+	double secs, double& beats_per_minute )
+{
+	if (curve == RampExponential) {
+		// Tempo exponential over beats: t0 * (t1/t0)^(beats/length)...
+		const double k = std::log(t1 / t0) / length;
+		const double x = std::max(1.0 - t0 * k * secs / 60.0, 1e-9);
+		beats_per_minute = t0 / x;
+		return -std::log(x) / k;
+	} else {
+		// Tempo linear over beats: t0 + (t1 - t0) * beats / length...
+		const double k = (t1 - t0) / length;
+		const double x = std::exp(k * secs / 60.0);
+		beats_per_minute = t0 * x;
+		return t0 * (x - 1.0) / k;
+	}
+}
+
+
+inline double jack_link_tempo::ramp_curve_secs ( int curve,
+	double t0, double t1, double length, double beats )
+{
+	if (curve == RampExponential) {
+		const double k = std::log(t1 / t0) / length;
+		return 60.0 * (1.0 - std::exp(-k * beats)) / (t0 * k);
+	} else {
+		const double k = (t1 - t0) / length;
+		return 60.0 * std::log(1.0 + k * beats / t0) / k;
+	}
+}
+
+
+inline double jack_link_tempo::beats ( uint32_t frame ) const
+{
+	if (!ramp) {
+		const double frames = frame_delta(frame, anchor_frame);
+		return anchor_beats + frames * tempo / (60.0 * srate);
+	}
+
+	// Constant tempo before and after the ramp...
+	const double secs = frame_delta(frame, ramp_frame) / srate;
+	const double ramp_secs = double(ramp_frames) / srate;
+	if (secs <= 0.0)
+		return ramp_beats + secs * ramp_tempo0 / 60.0;
+	if (secs >= ramp_secs) {
+		return ramp_beats + ramp_length
+			+ (secs - ramp_secs) * ramp_tempo1 / 60.0;
+	}
+
+	double beats_per_minute = ramp_tempo0;
+	return ramp_beats + std::min(ramp_length,
+		ramp_curve_beats(ramp_curve, ramp_tempo0, ramp_tempo1,
+			ramp_length, secs, beats_per_minute));
+}
+
+
+inline double jack_link_tempo::frame ( double beats ) const
+{
+	if (!ramp) {
+		return double(anchor_frame)
+			+ (beats - anchor_beats) * 60.0 * srate / tempo;
+	}
+
+	// Constant tempo before and after the ramp...
+	const double b = beats - ramp_beats;
+	double secs = 0.0;
+	if (b <= 0.0)
+		secs = 60.0 * b / ramp_tempo0;
+	else
+	if (b >= ramp_length) {
+		secs = double(ramp_frames) / srate
+			+ 60.0 * (b - ramp_length) / ramp_tempo1;
+	} else {
+		secs = ramp_curve_secs(ramp_curve,
+			ramp_tempo0, ramp_tempo1, ramp_length, b);
+	}
+
+	return double(ramp_frame) + secs * srate;
+}
+
+
+inline double jack_link_tempo::frame_delta ( uint32_t frame, uint32_t anchor )
+{
+	return (frame >= anchor
+		? double(frame - anchor)
+		: -double(anchor - frame));
+}
+
+
+// end of jack_link_tempo.hpp